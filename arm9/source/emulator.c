@@ -28,6 +28,25 @@ static Device *devscreen, *devctrl, *devmouse, *devaudio0;
 
 Uint8 dispswap = 0, debug = 0;
 
+/* Jumps a vector may take per frame before it is suspended, for the rest of
+   it to run in the frames that follow; 0, the default, lets vectors run to
+   the end. */
+#ifndef VECTOR_BUDGET
+#define VECTOR_BUDGET 0
+#endif
+u32 vector_budget = VECTOR_BUDGET;
+
+/* Whether start() may drop screen vectors while it is behind; frames the loop
+   overran, and screen vectors it dropped. */
+bool frame_pacing = true;
+u32 frames_missed, frames_skipped;
+
+/* Frames in which no vector ran and nothing was drawn. */
+u32 frames_idle;
+
+/* The keys of REG_KEYCNT, which can wake the idle wait: A to L. */
+#define PAD_KEYS 0x03ff
+
 #ifdef DEBUG
 static PrintConsole *mainConsole;
 #ifdef DEBUG_PROFILE
@@ -68,12 +87,72 @@ init(void)
 
 #pragma mark - Devices
 
+/* The memory of a bank for the expansion commands; bank numbers wrap around
+   the UXN_BANKS there are, as in Varvara. */
+static Uint8 *
+system_bank(Uxn *u, Uint16 bank)
+{
+	return &u->ram.dat[(bank % UXN_BANKS) * 0x10000];
+}
+
+/* Writing the address of a command block to the expansion port (0x2) runs
+   it; all fields but the first are big-endian shorts:
+     fill  00 length bank addr value(byte)
+     cpyl  01 length src-bank src-addr dst-bank dst-addr   copies upwards
+     cpyr  02 length src-bank src-addr dst-bank dst-addr   copies downwards
+   Addresses wrap around within their bank, and overlapping copies repeat
+   bytes exactly as a byte loop in that direction would. Reading the port
+   still gives the stack pointers. */
+static void
+system_expansion(Uxn *u, Uint16 cmd)
+{
+	Uint8 *ram = u->ram.dat, op = ram[cmd], *src, *dst;
+	Uint16 length = peek16(ram, cmd + 1), from, to, i;
+	if(!length)
+		return;
+	if(op == 0x00) {
+		Uint8 value = ram[(Uint16)(cmd + 7)];
+		to = peek16(ram, cmd + 5);
+		dst = system_bank(u, peek16(ram, cmd + 3));
+		if(to + length <= 0x10000)
+			memset(&dst[to], value, length);
+		else
+			for(i = 0; i < length; i++)
+				dst[(Uint16)(to + i)] = value;
+	} else if(op == 0x01 || op == 0x02) {
+		from = peek16(ram, cmd + 5);
+		to = peek16(ram, cmd + 9);
+		src = system_bank(u, peek16(ram, cmd + 3));
+		dst = system_bank(u, peek16(ram, cmd + 7));
+		// memmove gives the same result unless a range wraps, or the
+		// ranges overlap with the destination ahead in the direction of
+		// the copy, where the byte loop repeats what it has just copied.
+		if(from + length <= 0x10000 && to + length <= 0x10000
+			&& (src != dst || (op == 0x01 ? to <= from || to >= from + length : to >= from || to + length <= from)))
+			memmove(&dst[to], &src[from], length);
+		else if(op == 0x01)
+			for(i = 0; i < length; i++)
+				dst[(Uint16)(to + i)] = src[(Uint16)(from + i)];
+		else
+			for(i = length; i--;)
+				dst[(Uint16)(to + i)] = src[(Uint16)(from + i)];
+	} else
+		return;
+	if(dst == u->ram.dat) {
+		fuseuxn(u, to, length);
+		if(to + length > 0x10000)
+			fuseuxn(u, 0, to + length - 0x10000);
+	}
+}
+
 int
 system_talk(Device *d, Uint8 b0, Uint8 w)
 {
 	if(!w) {
 		d->dat[0x2] = d->u->wst.ptr;
 		d->dat[0x3] = d->u->rst.ptr;
+	} else if(b0 == 0x2 || b0 == 0x3) {
+		system_expansion(d->u, peek16(d->dat, 0x2));
 	} else {
 		putcolors(&ppu, &d->dat[0x8]);
 	}
@@ -113,29 +192,70 @@ screen_talk(Device *d, Uint8 b0, Uint8 w)
 		} else if(b0 == 0xe) {
 			Uint16 x = peek16(d->dat, 0x8);
 			Uint16 y = peek16(d->dat, 0xa);
-			Uint32 *layer = (d->dat[0xe] >> 6) & 0x1 ? ppu.fg : ppu.bg;
+			Uint8 layer = (d->dat[0xe] >> 6) & 0x1;
+			if(d->dat[0xe] & 0x80) {
+				/* fill from x, y to the right and bottom edges, or
+				   to the left and top ones when flipped */
+				Uint8 flipx = d->dat[0xe] & 0x10, flipy = d->dat[0xe] & 0x20;
+				ppu_fill(&ppu, layer, flipx ? 0 : x, flipy ? 0 : y,
+					flipx ? x : PPU_PIXELS_WIDTH, flipy ? y : PPU_PIXELS_HEIGHT, d->dat[0xe] & 0x3);
+				return 1;
+			}
 			ppu_pixel(&ppu, layer, x, y, d->dat[0xe] & 0x3);
                         if(d->dat[0x6] & 0x01) poke16(d->dat, 0x8, x + 1); /* auto x+1 */
                         if(d->dat[0x6] & 0x02) poke16(d->dat, 0xa, y + 1); /* auto y+1 */
 		} else if(b0 == 0xf) {
+			/* The high nibble of auto draws that many more sprites in one
+			   go, down the screen with auto x and across it with auto y,
+			   going back the other way when flipped; x and y then move on
+			   past the whole line. */
+			Uint8 ctrl = d->dat[0xf], autob = d->dat[0x6], length = autob >> 4;
+			Uint8 twobpp = ctrl >> 7, flipx = ctrl >> 4 & 0x1, flipy = ctrl >> 5 & 0x1;
 			Uint16 x = peek16(d->dat, 0x8);
 			Uint16 y = peek16(d->dat, 0xa);
-			Uint32 *layer = d->dat[0xf] >> 6 & 0x1 ? ppu.fg : ppu.bg;
-			Uint8 *addr = &d->mem[peek16(d->dat, 0xc)];
-			if(d->dat[0xf] & 0x80) {
-				ppu_2bpp(&ppu, layer, x, y, addr, d->dat[0xf] & 0xf, d->dat[0xf] >> 0x4 & 0x1, d->dat[0xf] >> 0x5 & 0x1);
-                                if(d->dat[0x6] & 0x04) poke16(d->dat, 0xc, peek16(d->dat, 0xc) + 16); /* auto addr+16 */
+			Uint16 addr = peek16(d->dat, 0xc), step = twobpp ? 16 : 8;
+			Uint8 layer = ctrl >> 6 & 0x1;
+			if(!length) {
+				if(twobpp)
+					ppu_2bpp(&ppu, layer, x, y, &d->mem[addr], ctrl & 0xf, flipx, flipy);
+				else
+					ppu_1bpp(&ppu, layer, x, y, &d->mem[addr], ctrl & 0xf, flipx, flipy);
+				if(autob & 0x04) poke16(d->dat, 0xc, addr + step); /* auto addr+8/16 */
+				if(autob & 0x01) poke16(d->dat, 0x8, x + 8); /* auto x+8 */
+				if(autob & 0x02) poke16(d->dat, 0xa, y + 8); /* auto y+8 */
 			} else {
-				ppu_1bpp(&ppu, layer, x, y, addr, d->dat[0xf] & 0xf, d->dat[0xf] >> 0x4 & 0x1, d->dat[0xf] >> 0x5 & 0x1);
-                                if(d->dat[0x6] & 0x04) poke16(d->dat, 0xc, peek16(d->dat, 0xc) + 8); /* auto addr+8 */
+				Sint16 dx = autob & 0x02 ? (flipx ? -8 : 8) : 0;
+				Sint16 dy = autob & 0x01 ? (flipy ? -8 : 8) : 0;
+				ppu_sprites(&ppu, layer, x, y, dx, dy, d->mem, addr, autob & 0x04 ? step : 0,
+					length + 1, ctrl & 0xf, flipx, flipy, twobpp);
+				if(autob & 0x04) poke16(d->dat, 0xc, addr + step * (length + 1));
+				if(autob & 0x01) poke16(d->dat, 0x8, x + (flipx ? -8 : 8));
+				if(autob & 0x02) poke16(d->dat, 0xa, y + (flipy ? -8 : 8));
 			}
-                        if(d->dat[0x6] & 0x01) poke16(d->dat, 0x8, x + 8); /* auto x+8 */
-                        if(d->dat[0x6] & 0x02) poke16(d->dat, 0xa, y + 8); /* auto y+8 */
 		}
 	}
 	return 1;
 }
 
+/* Short accesses: the width or height in one read, the vector in one write;
+   a short written over the pixel and sprite ports draws both. */
+ITCM_ARM_CODE
+int
+screen_talk16(Device *d, Uint8 b0, Uint8 w)
+{
+	if(!w) {
+		poke16(d->dat, 0x2, PPU_PIXELS_WIDTH);
+		poke16(d->dat, 0x4, PPU_PIXELS_HEIGHT);
+		return 1;
+	}
+	if(b0 == 0x0) {
+		d->vector = peek16(d->dat, 0x0);
+		return 1;
+	}
+	return (!(d->whook >> b0 & 1) || screen_talk(d, b0, 1))
+		&& (!(d->whook >> ((b0 + 1) & 0xf) & 1) || screen_talk(d, (b0 + 1) & 0xf, 1));
+}
+
 static Uint16
 get_entry(char *p, Uint16 len, const char *pathname, const char *basename, int fail_nonzero)
 {
@@ -192,12 +312,15 @@ file_talk(Device *d, Uint8 b0, Uint8 w)
 			dprintf("%04x bytes\n", result);
 			fclose(f);
 		}
+		if(read)
+			fuseuxn(d->u, addr, result);
 		poke16(d->dat, 0x2, result);
 	}
 	return 1;
 }
 
-static int
+ITCM_ARM_CODE
+int
 audio_talk(Device *d, Uint8 b0, Uint8 w)
 {
 	Apu *c = &apu[d - devaudio0];
@@ -229,10 +352,32 @@ nil_talk(Device *d, Uint8 b0, Uint8 w)
 
 #pragma mark - Generics
 
-void
+/* Whether running vec would do nothing: no vector set, or one that starts
+   with BRK. */
+static bool
+emptyvector(Uxn *u, Uint16 vec)
+{
+	return !vec || !u->ram.dat[vec];
+}
+
+/* While a suspended vector holds the stacks, input vectors cannot run: the
+   keys typed meanwhile queue up, and the controller and mouse vectors are
+   owed a run, which they get once it has finished. */
+#define CTRL_QUEUE 16
+static Uint8 ctrl_queue[CTRL_QUEUE];
+static u32 ctrl_queue_head, ctrl_queue_tail;
+static bool ctrl_pending, mouse_pending;
+
+static void
+ctrl_key(Uint8 key)
+{
+	if(ctrl_queue_head - ctrl_queue_tail < CTRL_QUEUE)
+		ctrl_queue[ctrl_queue_head++ % CTRL_QUEUE] = key;
+}
+
+bool
 doctrl(Uxn *u)
 {
-	bool changed = false;
 	u8 old_flags = devctrl->dat[2];
 	int key = dispswap ? -1 : keyboardUpdate();
 
@@ -252,8 +397,7 @@ doctrl(Uxn *u)
 
 	switch (key) {
 		case DVK_FOLD:
-			devctrl->dat[3] = 27;
-			changed = true;
+			ctrl_key(27);
 			break;
 		case DVK_UP:
 			devctrl->dat[2] |= (1 << 4);
@@ -268,27 +412,33 @@ doctrl(Uxn *u)
 			devctrl->dat[2] |= (1 << 7);
 			break;
 		case DVK_ENTER:
-			devctrl->dat[3] = 13;
-			changed = true;
+			ctrl_key(13);
 			break;
 		default:
-			if (key > 0) {
-				devctrl->dat[3] = key;
-				changed = true;
-			}
+			if (key > 0)
+				ctrl_key(key);
 			break;
 	}
 
-	changed |= old_flags != devctrl->dat[2];
-	if (changed) {
-		evaluxn(u, devctrl->vector);
-		devctrl->dat[3] = 0;
+	// One key per run of the vector, the others waiting for the next frames.
+	ctrl_pending |= old_flags != devctrl->dat[2] || ctrl_queue_head != ctrl_queue_tail;
+	if (!ctrl_pending || u->suspended)
+		return false;
+	ctrl_pending = false;
+	if (emptyvector(u, devctrl->vector)) {
+		ctrl_queue_tail = ctrl_queue_head;
+		return false;
 	}
+	if (ctrl_queue_head != ctrl_queue_tail)
+		devctrl->dat[3] = ctrl_queue[ctrl_queue_tail++ % CTRL_QUEUE];
+	evaluxn(u, devctrl->vector);
+	devctrl->dat[3] = 0;
+	return true;
 }
 
 static bool istouching = false;
 
-void
+bool
 domouse(Uxn *u)
 {
 	bool changed = false;
@@ -315,9 +465,14 @@ domouse(Uxn *u)
 		changed = true;
 	}
 
-	if (changed) {
-		evaluxn(u, devmouse->vector);
-	}
+	mouse_pending |= changed;
+	if (!mouse_pending || u->suspended)
+		return false;
+	mouse_pending = false;
+	if (emptyvector(u, devmouse->vector))
+		return false;
+	evaluxn(u, devmouse->vector);
+	return true;
 }
 
 int
@@ -354,41 +509,257 @@ profiler_ticks(Uint32 tticks, int pos, const char *name)
 	iprintf("\x1b[%d;0H\x1b[0K%s: %d, peak %d\n", pos, name, tticks, tticks_peak[pos]);
 	consoleSelect(mainConsole);
 }
+
+/* profile.bin holds "UXNPROF1", then the execution counts of the 256 opcodes
+   and of the 65536 addresses, as little-endian 32-bit words; etc/uxnprof.py
+   reads it. The counts start over after each dump. */
+void
+profiler_dump(void)
+{
+	FILE *f;
+	if(!(f = fopen("profile.bin", "wb"))) {
+		dprintf("Profile: could not write profile.bin\n");
+		return;
+	}
+	fwrite("UXNPROF1", 8, 1, f);
+	fwrite(uxn_opcode_counts, sizeof(uxn_opcode_counts), 1, f);
+	fwrite(uxn_addr_counts, sizeof(uxn_addr_counts), 1, f);
+	fclose(f);
+	memset(uxn_opcode_counts, 0, sizeof(uxn_opcode_counts));
+	memset(uxn_addr_counts, 0, sizeof(uxn_addr_counts));
+	dprintf("Profile: wrote profile.bin\n");
+}
+
+/* The sampling profiler reads uxn_at and uxn_vector from a timer interrupt,
+   PROFILE_SAMPLE_HZ times a second, along with the top of the return stack.
+   The samples go through a ring buffer, which the frame loop appends to
+   samples.bin: "UXNSAMP1", then one Sample after the other, in little-endian
+   order. etc/uxnprof.py turns them into a flat profile or folded stacks. */
+#ifndef PROFILE_SAMPLE_HZ
+#define PROFILE_SAMPLE_HZ 1000
+#endif
+#define SAMPLE_DEPTH 16 /* bytes of the return stack */
+#define SAMPLE_RING 1024
+
+typedef struct {
+	Uint16 vector, pc; /* vector 0 if none was running */
+	Uint8 depth, pad;
+	Uint8 rst[SAMPLE_DEPTH]; /* the top depth bytes, oldest first */
+} Sample;
+
+static Sample samples[SAMPLE_RING];
+static volatile u32 sample_head, sample_tail, samples_dropped;
+static Uxn *sample_uxn;
+static FILE *sample_file;
+
+static void
+profiler_sample(void)
+{
+	u32 at = uxn_at;
+	Uint8 rptr = at >> 16, n = rptr < SAMPLE_DEPTH ? rptr : SAMPLE_DEPTH;
+	Sample *s;
+	if(sample_head - sample_tail == SAMPLE_RING) {
+		samples_dropped++;
+		return;
+	}
+	s = &samples[sample_head % SAMPLE_RING];
+	s->vector = uxn_vector;
+	s->pc = s->vector ? at : 0;
+	s->depth = s->vector ? n : 0;
+	memcpy(s->rst, &sample_uxn->rst.dat[rptr - s->depth], s->depth);
+	sample_head++;
+}
+
+/* Writes out the samples taken so far, once the ring is half full unless
+   all of them are asked for. */
+void
+profiler_flush(int all)
+{
+	u32 head = sample_head, tail = sample_tail;
+	if(!sample_file || head - tail < (all ? 1 : SAMPLE_RING / 2))
+		return;
+	if(head / SAMPLE_RING != tail / SAMPLE_RING) {
+		fwrite(&samples[tail % SAMPLE_RING], sizeof(Sample), SAMPLE_RING - tail % SAMPLE_RING, sample_file);
+		tail += SAMPLE_RING - tail % SAMPLE_RING;
+	}
+	fwrite(&samples[tail % SAMPLE_RING], sizeof(Sample), head - tail, sample_file);
+	fflush(sample_file);
+	sample_tail = head;
+	if(samples_dropped)
+		dprintf("Profile: %d samples dropped\n", (int)samples_dropped);
+	samples_dropped = 0;
+}
+
+static void
+profiler_exit(void)
+{
+	profiler_flush(1);
+}
+
+void
+profiler_start(Uxn *u)
+{
+	sample_uxn = u;
+	if(!(sample_file = fopen("samples.bin", "wb"))) {
+		dprintf("Profile: could not write samples.bin\n");
+		return;
+	}
+	fwrite("UXNSAMP1", 8, 1, sample_file);
+	atexit(profiler_exit);
+	timerStart(2, ClockDivider_64, TIMER_FREQ_64(PROFILE_SAMPLE_HZ), profiler_sample);
+}
+
+/* Vectors that ran out of budget, and the most frames one of them took. */
+void
+profiler_suspended(Uxn *u, int pos)
+{
+	static u32 vectors, frames, longest;
+	if(u->suspended) {
+		if(!frames++)
+			vectors++;
+		if(longest < frames)
+			longest = frames;
+	} else
+		frames = 0;
+	consoleSelect(&profileConsole);
+	iprintf("\x1b[%d;0H\x1b[0Ksusp: %d, longest %d frames", pos, (int)vectors, (int)longest);
+	consoleSelect(mainConsole);
+}
+
+void
+profiler_frames(int pos)
+{
+	consoleSelect(&profileConsole);
+	iprintf("\x1b[%d;0H\x1b[0Kmiss: %d, drop: %d, idle: %d", pos, (int)frames_missed, (int)frames_skipped, (int)frames_idle);
+	consoleSelect(mainConsole);
+}
+
+/* The tiles and bytes the last copyppu moved to VRAM. */
+void
+profiler_copied(int pos)
+{
+	static Uint32 tiles, bytes;
+	consoleSelect(&profileConsole);
+	iprintf("\x1b[%d;0H\x1b[0Kcopy: %d tiles, %d bytes", pos, (int)(ppu_tiles_copied - tiles), (int)(ppu_bytes_copied - bytes));
+	consoleSelect(mainConsole);
+	tiles = ppu_tiles_copied;
+	bytes = ppu_bytes_copied;
+}
+
+void
+profiler_dispatches(int pos)
+{
+	static unsigned long long instructions, fused;
+	Uint32 n = uxn_instructions - instructions, f = uxn_fused - fused;
+	instructions = uxn_instructions;
+	fused = uxn_fused;
+	consoleSelect(&profileConsole);
+	iprintf("\x1b[%d;0H\x1b[0Kops: %d, disp: %d (-%d%%)", pos, n, n - f, n ? f * 100 / n : 0);
+	consoleSelect(mainConsole);
+}
 #endif
 
+/* Bus clock ticks per frame: 263 lines of 355 dots, 6 cycles each. */
+#define FRAME_TICKS (263 * 355 * 6)
+
 int
 start(Uxn *u)
 {
+	u32 tframe, tphase, tnow, frames, missed = 0;
+	u32 screen_ticks = 0; /* what the last screen vector took */
+	bool behind = false, ran = true, skipped = false;
+
 #ifdef DEBUG_PROFILE
-	u32 tticks;
+	profiler_start(u);
 #endif
-
 	evaluxn(u, 0x0100);
+	tframe = timer_ticks(0);
 	while(1) {
 		scanKeys();
 #ifdef DEBUG_PROFILE
-		// X+Y in debugger mode resets tticks_peak
-		if ((keysHeld() & (KEY_X | KEY_Y)) == (KEY_X | KEY_Y))
+		// X+Y in debugger mode resets tticks_peak, and dumps the
+		// execution counts when pressed
+		if ((keysHeld() & (KEY_X | KEY_Y)) == (KEY_X | KEY_Y)) {
 			memset(tticks_peak, 0, sizeof(tticks_peak));
-		tticks = timer_ticks(0);
+			if (keysDown() & (KEY_X | KEY_Y))
+				profiler_dump();
+		}
 #endif
-		doctrl(u);
-		domouse(u);
+		tphase = timer_ticks(0);
+		ran |= doctrl(u);
+		ran |= domouse(u);
+		tnow = timer_ticks(0);
 #ifdef DEBUG_PROFILE
-		profiler_ticks(timer_ticks(0) - tticks, 1, "ctrl");
-		tticks = timer_ticks(0);
+		profiler_ticks(tnow - tphase, 1, "ctrl");
 #endif
-		evaluxn(u, devscreen->vector);
-#ifdef DEBUG_PROFILE
-		profiler_ticks(timer_ticks(0) - tticks, 0, "main");
+		tphase = tnow;
+		// A suspended vector goes on before any other can run. Otherwise,
+		// while the loop is behind, a screen vector that would not fit in
+		// what is left of the frame is dropped, once: the next one stands
+		// for both, and with SCREEN_SKIP finds the frames it missed in
+		// Screen/skip.
+		if(u->suspended) {
+			resumeuxn(u);
+			ran = true;
+			missed++;
+		} else if(emptyvector(u, devscreen->vector)) {
+			missed = 0;
+		} else if(frame_pacing && behind && tnow - tframe + screen_ticks > FRAME_TICKS) {
+			behind = false;
+			skipped = true;
+			missed++;
+			frames_skipped++;
+		} else {
+#ifdef SCREEN_SKIP
+			devscreen->dat[0x7] = missed > 0xff ? 0xff : missed;
 #endif
-		swiWaitForVBlank();
+			missed = 0;
+			evaluxn(u, devscreen->vector);
+			screen_ticks = timer_ticks(0) - tphase;
+			ran = true;
+		}
 #ifdef DEBUG_PROFILE
-		tticks = timer_ticks(0);
+		profiler_ticks(timer_ticks(0) - tphase, 0, "main");
+		profiler_dispatches(3);
+		profiler_suspended(u, 4);
 #endif
-		copyppu(&ppu);
+		// When no vector ran and no tile is left to copy, the frame is idle:
+		// nothing can change before a key is pressed, so the wait ends on
+		// that as well as on the next frame. A frame whose screen vector was
+		// dropped is behind, not idle. The key interrupt is level-triggered,
+		// so it is only enabled for the wait, and not at all while keys are
+		// held, which would end it at once.
+		if(!ran && !skipped && !ppu_dirty()) {
+			frames_idle++;
+			if(keysHeld() & PAD_KEYS)
+				swiIntrWait(1, IRQ_VBLANK);
+			else {
+				REG_KEYCNT = (1 << 14) | PAD_KEYS;
+				irqEnable(IRQ_KEYS);
+				swiIntrWait(1, IRQ_VBLANK | IRQ_KEYS);
+				irqDisable(IRQ_KEYS);
+				REG_KEYCNT = PAD_KEYS;
+			}
+		} else
+			swiWaitForVBlank();
+		// Whole frames since the last pass, more than one if it overran;
+		// all but one of them are missed by the screen vector.
+		tnow = timer_ticks(0);
+		frames = (tnow - tframe + FRAME_TICKS / 2) / FRAME_TICKS;
+		tframe = tnow;
+		behind = frames > 1;
+		missed += frames ? frames - 1 : 0;
+		frames_missed += frames ? frames - 1 : 0;
+		// Tiles are only made dirty by the vectors; if none ran since the
+		// last copy, there is nothing to copy.
+		if(ran)
+			copyppu(&ppu);
+		ran = skipped = false;
 #ifdef DEBUG_PROFILE
-		profiler_ticks(timer_ticks(0) - tticks, 2, "flip");
+		profiler_ticks(timer_ticks(0) - tnow, 2, "flip");
+		profiler_frames(5);
+		profiler_copied(6);
+		profiler_flush(0);
 #endif
 	}
 	return 1;
@@ -410,26 +781,27 @@ main(int argc, char **argv)
 	mainConsole = consoleDemoInit();
 
 #ifdef DEBUG_PROFILE
-	// Timers 0-1 - profiling timers
-	TIMER0_DATA = 0;
-	TIMER1_DATA = 0;
-	TIMER0_CR = TIMER_ENABLE | TIMER_DIV_1;
-	TIMER1_CR = TIMER_ENABLE | TIMER_CASCADE;
-
-	consoleSetWindow(mainConsole, 0, 0, 32, 11);
+	consoleSetWindow(mainConsole, 0, 0, 32, 8);
 
 	profileConsole = *mainConsole;
-	consoleSetWindow(&profileConsole, 0, 11, 32, 4);
+	consoleSetWindow(&profileConsole, 0, 8, 32, 7);
 #else
 	consoleSetWindow(mainConsole, 0, 0, 32, 14);
 #endif
 	consoleSelect(mainConsole);
 #endif
 
+	// Timers 0-1 - frame and profiling timers
+	TIMER0_DATA = 0;
+	TIMER1_DATA = 0;
+	TIMER0_CR = TIMER_ENABLE | TIMER_DIV_1;
+	TIMER1_CR = TIMER_ENABLE | TIMER_CASCADE;
+
 	keyboardDemoInit();
 
 	if(!bootuxn(&u))
 		return error("Boot", "Failed");
+	u.budget = vector_budget;
 	if (!fatInitDefault())
 		return error("FAT init", "Failed");
 	chdir("/uxn");
@@ -443,26 +815,31 @@ main(int argc, char **argv)
 
 	keyboardShow();
 
-	portuxn(&u, 0x0, "system", system_talk);
+	// The ports each handler acts on when read and when written; all others
+	// are left to the interpreter as plain data.
+	// system_talk and datetime_talk take short accesses as they are: they
+	// act on the port pair as a whole.
+	portuxn(&u, 0x0, "system", system_talk, 0x000c, 0x3f08)->talk16 = system_talk; /* stacks; expansion, colors */
 #ifdef DEBUG
-	portuxn(&u, 0x1, "console", console_talk);
+	portuxn(&u, 0x1, "console", console_talk, 0x0000, 0xff02); /* vector, output */
 #else
-	portuxn(&u, 0x1, "---", nil_talk);
+	portuxn(&u, 0x1, "---", nil_talk, 0x0000, 0x0002);
 #endif
-	devscreen = portuxn(&u, 0x2, "screen", screen_talk);
-	devaudio0 = portuxn(&u, 0x3, "audio0", audio_talk);
-	portuxn(&u, 0x4, "audio1", audio_talk);
-	portuxn(&u, 0x5, "audio2", audio_talk);
-	portuxn(&u, 0x6, "audio3", audio_talk);
-	portuxn(&u, 0x7, "---", nil_talk);
-	devctrl = portuxn(&u, 0x8, "controller", nil_talk);
-	devmouse = portuxn(&u, 0x9, "mouse", nil_talk);
-	portuxn(&u, 0xa, "file", file_talk);
-	portuxn(&u, 0xb, "datetime", datetime_talk);
-	portuxn(&u, 0xc, "---", nil_talk);
-	portuxn(&u, 0xd, "---", nil_talk);
-	portuxn(&u, 0xe, "---", nil_talk);
-	portuxn(&u, 0xf, "---", nil_talk);
+	devscreen = portuxn(&u, 0x2, "screen", screen_talk, 0x003c, 0xc002); /* size; vector, pixel, sprite */
+	devscreen->talk16 = screen_talk16;
+	devaudio0 = portuxn(&u, 0x3, "audio0", audio_talk, 0x0014, 0x8000); /* position, output; pitch */
+	portuxn(&u, 0x4, "audio1", audio_talk, 0x0014, 0x8000);
+	portuxn(&u, 0x5, "audio2", audio_talk, 0x0014, 0x8000);
+	portuxn(&u, 0x6, "audio3", audio_talk, 0x0014, 0x8000);
+	portuxn(&u, 0x7, "---", nil_talk, 0x0000, 0x0002);
+	devctrl = portuxn(&u, 0x8, "controller", nil_talk, 0x0000, 0x0002);
+	devmouse = portuxn(&u, 0x9, "mouse", nil_talk, 0x0000, 0x0002);
+	portuxn(&u, 0xa, "file", file_talk, 0x0000, 0xa000); /* load, save */
+	portuxn(&u, 0xb, "datetime", datetime_talk, 0x07ff, 0x0000)->talk16 = datetime_talk;
+	portuxn(&u, 0xc, "---", nil_talk, 0x0000, 0x0002);
+	portuxn(&u, 0xd, "---", nil_talk, 0x0000, 0x0002);
+	portuxn(&u, 0xe, "---", nil_talk, 0x0000, 0x0002);
+	portuxn(&u, 0xf, "---", nil_talk, 0x0000, 0x0002);
 
 	/* Write screen size to dev/screen */
 	poke16(devscreen->dat, 2, PPU_PIXELS_WIDTH);
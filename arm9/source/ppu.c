@@ -47,6 +47,15 @@ static Uint8 blending[5][16] = {
 DTCM_BSS
 static Uint32 tile_dirty[PPU_TILES_HEIGHT + 1];
 
+/* The tiles a layer is drawn into, and the position of its two bits in each
+   pixel. */
+#define LAYER_TILES(p, layer) ((layer) ? (p)->fg : (p)->bg)
+#ifdef PPU_PACKED
+#define LAYER_SHIFT(layer) ((layer) << 1)
+#else
+#define LAYER_SHIFT(layer) 0
+#endif
+
 DTCM_DATA
 static Uint32 lut_expand_8_32[256] = {
 #include "lut_expand_8_32.inc"
@@ -61,206 +70,262 @@ void
 putcolors(Ppu *p, Uint8 *addr)
 {
 	int i;
+	Uint16 colors[4];
 	for(i = 0; i < 4; ++i) {
 		Uint8
 			r = (*(addr + (i >> 1)) >> (!(i & 1) << 2)) & 0x0f,
 			g = (*(addr + 2 + (i >> 1)) >> (!(i & 1) << 2)) & 0x0f,
 			b = (*(addr + 4 + (i >> 1)) >> (!(i & 1) << 2)) & 0x0f;
-		BG_PALETTE[i] = RGB15(
+		colors[i] = RGB15(
 			(r << 1) | (r >> 3),
 			(g << 1) | (g >> 3),
 			(b << 1) | (b >> 3)
 		);
 	}
+#ifdef PPU_PACKED
+	// pixel fg * 4 + bg shows fg over bg, and bg where fg is clear
+	for(i = 0; i < 16; ++i)
+		BG_PALETTE[i] = colors[i >> 2 ? i >> 2 : i & 3];
+#else
+	for(i = 0; i < 4; ++i)
+		BG_PALETTE[i] = colors[i];
+#endif
 }
 
 ITCM_ARM_CODE
 void
-ppu_pixel(Ppu *p, Uint32 *layer, Uint16 x, Uint16 y, Uint8 color)
+ppu_pixel(Ppu *p, Uint8 layer, Uint16 x, Uint16 y, Uint8 color)
 {
 	if(x >= PPU_TILES_WIDTH * 8 || y >= PPU_TILES_HEIGHT * 8)
 		return;
+	Uint32 *tiles = LAYER_TILES(p, layer);
 	Uint32 pos = ((y & 7) + (((x >> 3) + (y >> 3) * PPU_TILES_WIDTH) * 8));
-	Uint32 shift = (x & 7) << 2;
-	layer[pos] = (layer[pos] & (~(0xF << shift))) | (color << shift);
+	Uint32 shift = ((x & 7) << 2) + LAYER_SHIFT(layer);
+	tiles[pos] = (tiles[pos] & (~(0x3 << shift))) | (color << shift);
 	tile_dirty[y >> 3] |= 1 << (x >> 3);
 }
 
+/* Fills the pixels from (x1, y1) up to, but not including, (x2, y2): whole
+   words for the rows of tiles inside the rectangle, masked ones at its left
+   and right edges, and the dirty flags once per row of tiles. */
 ITCM_ARM_CODE
 void
-ppu_1bpp(Ppu *p, Uint32 *layer, Uint16 x, Uint16 y, Uint8 *sprite, Uint8 color, Uint8 flipx, Uint8 flipy)
+ppu_fill(Ppu *p, Uint8 layer, Uint16 x1, Uint16 y1, Uint16 x2, Uint16 y2, Uint8 color)
+{
+	Uint32 bits = 0x33333333 << LAYER_SHIFT(layer), data = ((color & 3) * 0x11111111) << LAYER_SHIFT(layer);
+	Uint32 *tiles = LAYER_TILES(p, layer), lmask, rmask, columns, *row;
+	Uint16 tx, tx1, tx2, y;
+
+	if (x2 > PPU_TILES_WIDTH * 8) x2 = PPU_TILES_WIDTH * 8;
+	if (y2 > PPU_TILES_HEIGHT * 8) y2 = PPU_TILES_HEIGHT * 8;
+	if (x1 >= x2 || y1 >= y2)
+		return;
+
+	tx1 = x1 >> 3;
+	tx2 = (x2 - 1) >> 3;
+	// the pixels of the first and last tile inside the rectangle
+	lmask = (0xFFFFFFFF << ((x1 & 7) << 2)) & bits;
+	rmask = (0xFFFFFFFF >> ((-x2 & 7) << 2)) & bits;
+	if (tx1 == tx2)
+		lmask &= rmask;
+	columns = (2u << tx2) - (1u << tx1);
+
+	for (y = y1; y < y2; y++) {
+		row = &tiles[(y & 7) + (y >> 3) * PPU_TILES_WIDTH * 8];
+		row[tx1 << 3] = (row[tx1 << 3] & ~lmask) | (data & lmask);
+		for (tx = tx1 + 1; tx < tx2; tx++)
+			row[tx << 3] = (row[tx << 3] & ~bits) | data;
+		if (tx2 > tx1)
+			row[tx2 << 3] = (row[tx2 << 3] & ~rmask) | (data & rmask);
+		if ((y & 7) == 7 || y == y2 - 1)
+			tile_dirty[y >> 3] |= columns;
+	}
+}
+
+/* The sprite drawing loops leave marking the tiles they touch to their
+   callers, which can then do it once for a whole row of sprites. */
+static inline void
+blit_1bpp(Ppu *p, Uint8 layer, Uint16 x, Uint16 y, Uint8 *sprite, Uint8 color, Uint8 flipx, Uint8 flipy)
 {
 	Uint8 sprline;
 	Uint8 xrightedge = x < ((PPU_TILES_WIDTH - 1) * 8);
 	Uint16 v;
-	Uint32 dirtyflag = (1 << (x >> 3)) | (1 << ((x + 7) >> 3));
 
 	Uint32 layerpos = ((y & 7) + (((x >> 3) + (y >> 3) * PPU_TILES_WIDTH) * 8));
-	Uint32 *layerptr = &layer[layerpos];
+	Uint32 *layerptr = &LAYER_TILES(p, layer)[layerpos];
 	Uint32 shift = (x & 7) << 2;
 	Uint32 *lut_expand = flipx ? lut_expand_8_32 : lut_expand_8_32_flipx;
 
+	/* The clear pixels are drawn, in the high bits of the color, only in the
+	   opaque modes, which also overwrite every pixel of the layer. */
+	u32 bits = 3 << LAYER_SHIFT(layer);
+	u32 c1 = (color & 3) << LAYER_SHIFT(layer), c0 = blending[4][color] ? (color >> 2) << LAYER_SHIFT(layer) : 0;
+	u32 opaque = blending[4][color] ? bits * 0x11111111 : 0;
+
+#ifdef UXNDS_HOST
+	ppu_sprites_drawn++;
+#endif
 	if (flipy) flipy = 7;
 
 	if(x >= PPU_TILES_WIDTH * 8 || y >= PPU_TILES_HEIGHT * 8)
 		return;
 
-	if (blending[4][color]) {
-		u64 mask = ~((u64)0xFFFFFFFF << shift);
-
-		for (v = 0; v < 8; v++, layerptr++) {
-			if ((y + v) >= (PPU_TILES_HEIGHT * 8)) break;
-
+	if (!((x | y) & 7)) {
+		// on a tile boundary, the rows are the eight words of one tile
+		for (v = 0; v < 8; v++) {
 			sprline = sprite[v ^ flipy];
-			u64 data = (u64)(lut_expand[sprline] * (color & 3)) << shift;
-			data |= (u64)(lut_expand[sprline ^ 0xFF] * (color >> 2)) << shift;
-
-			layerptr[0] = (layerptr[0] & mask) | data;
-			if (xrightedge) layerptr[8] = (layerptr[8] & (mask >> 32)) | (data >> 32);
-
-			if (((y + v) & 7) == 7) layerptr += (PPU_TILES_WIDTH - 1) * 8;
+			layerptr[v] = (layerptr[v] & ~((lut_expand[sprline] * bits) | opaque))
+				| (lut_expand[sprline] * c1) | (lut_expand[sprline ^ 0xFF] * c0);
 		}
-	} else {
-		for (v = 0; v < 8; v++, layerptr++) {
-			if ((y + v) >= (PPU_TILES_HEIGHT * 8)) break;
+		return;
+	}
 
-			sprline = sprite[v ^ flipy];
-			u64 mask = ~((u64)(lut_expand[sprline] * 0xF) << shift);
-			u64 data = (u64)(lut_expand[sprline] * (color & 3)) << shift;
+	for (v = 0; v < 8; v++, layerptr++) {
+		if ((y + v) >= (PPU_TILES_HEIGHT * 8)) break;
 
-			layerptr[0] = (layerptr[0] & mask) | data;
-			if (xrightedge) layerptr[8] = (layerptr[8] & (mask >> 32)) | (data >> 32);
+		sprline = sprite[v ^ flipy];
+		u64 mask = ~((u64)((lut_expand[sprline] * bits) | opaque) << shift);
+		u64 data = (u64)(lut_expand[sprline] * c1) << shift;
+		data |= (u64)(lut_expand[sprline ^ 0xFF] * c0) << shift;
 
-			if (((y + v) & 7) == 7) layerptr += (PPU_TILES_WIDTH - 1) * 8;
-		}
-	}
+		layerptr[0] = (layerptr[0] & mask) | data;
+		if (xrightedge) layerptr[8] = (layerptr[8] & (mask >> 32)) | (data >> 32);
 
-	tile_dirty[y >> 3] |= dirtyflag;
-	tile_dirty[(y + 7) >> 3] |= dirtyflag;
+		if (((y + v) & 7) == 7) layerptr += (PPU_TILES_WIDTH - 1) * 8;
+	}
 }
 
-#ifndef DEBUG
-ITCM_ARM_CODE
-#endif
-void
-ppu_2bpp(Ppu *p, Uint32 *layer, Uint16 x, Uint16 y, Uint8 *sprite, Uint8 color, Uint8 flipx, Uint8 flipy)
+static inline void
+blit_2bpp(Ppu *p, Uint8 layer, Uint16 x, Uint16 y, Uint8 *sprite, Uint8 color, Uint8 flipx, Uint8 flipy)
 {
 	Uint8 sprline1, sprline2;
 	Uint8 xrightedge = x < ((PPU_TILES_WIDTH - 1) * 8);
-	Uint16 v, h;
-	Uint32 dirtyflag = (1 << (x >> 3)) | (1 << ((x + 7) >> 3));
+	Uint16 v;
 
 	Uint32 layerpos = ((y & 7) + (((x >> 3) + (y >> 3) * PPU_TILES_WIDTH) * 8));
-	Uint32 *layerptr = &layer[layerpos];
+	Uint32 *layerptr = &LAYER_TILES(p, layer)[layerpos];
 	Uint32 shift = (x & 7) << 2;
+	Uint32 *lut_expand = flipx ? lut_expand_8_32 : lut_expand_8_32_flipx;
 
+	/* Bit-sliced blending: with the planes widened to both bits of every
+	   nibble, each output pixel is c0 ^ (p1 & (c0 ^ c1)) ^ (p2 & (c0 ^ c2))
+	   ^ (p1 & p2 & (c0 ^ c1 ^ c2 ^ c3)) for the colors c0..c3 the mode gives
+	   the four channels, which is worked out for all eight pixels at once.
+	   Channel 0 is drawn only in the opaque modes, which also overwrite every
+	   pixel of the layer. */
+	u32 bits = 3 << LAYER_SHIFT(layer), ones = 0x11111111 << LAYER_SHIFT(layer);
+	u32 c0 = blending[4][color] ? blending[0][color] : 0;
+	u32 c1 = blending[1][color], c2 = blending[2][color], c3 = blending[3][color];
+	u32 k0 = c0 * ones, k1 = (c0 ^ c1) * ones;
+	u32 k2 = (c0 ^ c2) * ones, k12 = (c0 ^ c1 ^ c2 ^ c3) * ones;
+	u32 opaque = blending[4][color] ? bits * 0x11111111 : 0;
+
+#ifdef UXNDS_HOST
+	ppu_sprites_drawn++;
+#endif
 	if (flipy) flipy = 7;
 
 	if(x >= PPU_TILES_WIDTH * 8 || y >= PPU_TILES_HEIGHT * 8)
 		return;
 
-	if (color == 1) {
-		Uint32 *lut_expand = flipx ? lut_expand_8_32 : lut_expand_8_32_flipx;
-		u64 mask = ~((u64)0xFFFFFFFF << shift);
-
-		for (v = 0; v < 8; v++, layerptr++) {
-			if ((y + v) >= (PPU_TILES_HEIGHT * 8)) break;
-
-			sprline1 = sprite[v ^ flipy];
-			sprline2 = sprite[(v ^ flipy) | 8];
-
-			u32 data32 = (lut_expand[sprline1]) | (lut_expand[sprline2] << 1);
-			u64 data = ((u64) (data32 & 0x33333333)) << shift;
-
-			layerptr[0] = (layerptr[0] & mask) | data;
-			if (xrightedge) layerptr[8] = (layerptr[8] & (mask >> 32)) | (data >> 32);
-
-			if (((y + v) & 7) == 7) layerptr += (PPU_TILES_WIDTH - 1) * 8;
+	if (!((x | y) & 7)) {
+		// on a tile boundary, the rows are the eight words of one tile
+		for (v = 0; v < 8; v++) {
+			u32 plane1 = lut_expand[sprite[v ^ flipy]] * bits, plane2 = lut_expand[sprite[(v ^ flipy) | 8]] * bits;
+			layerptr[v] = (layerptr[v] & ~(plane1 | plane2 | opaque))
+				| (k0 ^ (plane1 & k1) ^ (plane2 & k2) ^ (plane1 & plane2 & k12));
 		}
-	} else if (blending[4][color]) {
-		u64 mask = ~((u64)0xFFFFFFFF << shift);
+		return;
+	}
 
-		for (v = 0; v < 8; v++, layerptr++) {
-			if ((y + v) >= (PPU_TILES_HEIGHT * 8)) break;
+	for (v = 0; v < 8; v++, layerptr++) {
+		if ((y + v) >= (PPU_TILES_HEIGHT * 8)) break;
 
-			Uint8 ch1 = sprite[v ^ flipy];
-			Uint8 ch2 = sprite[(v ^ flipy) | 8];
-			u32 data32 = 0;
+		sprline1 = sprite[v ^ flipy];
+		sprline2 = sprite[(v ^ flipy) | 8];
 
-			if (!flipx) {
-				for (h = 0; h < 8; h++) {
-					data32 <<= 4;
+		u32 plane1 = lut_expand[sprline1] * bits, plane2 = lut_expand[sprline2] * bits;
+		u32 data32 = k0 ^ (plane1 & k1) ^ (plane2 & k2) ^ (plane1 & plane2 & k12);
+		u64 data = ((u64) data32) << shift;
+		u64 mask = ~(((u64) (plane1 | plane2 | opaque)) << shift);
 
-					Uint8 ch = (ch1 & 1) | ((ch2 & 1) << 1);
-					data32 |= blending[ch][color];
+		layerptr[0] = (layerptr[0] & mask) | data;
+		if (xrightedge) layerptr[8] = (layerptr[8] & (mask >> 32)) | (data >> 32);
 
-					ch1 >>= 1; ch2 >>= 1;
-				}
-			} else {
-				for (h = 0; h < 8; h++) {
-					data32 <<= 4;
+		if (((y + v) & 7) == 7) layerptr += (PPU_TILES_WIDTH - 1) * 8;
+	}
+}
 
-					Uint8 ch = (ch1 >> 7) | ((ch2 >> 7) << 1);
-					data32 |= blending[ch][color];
+/* Marks the tiles from the one holding pixel (x0, y0) to the one holding
+   (x1, y1), both on screen. */
+static inline void
+mark_dirty(Uint16 x0, Uint16 y0, Uint16 x1, Uint16 y1)
+{
+	Uint32 columns = (2u << (x1 >> 3)) - (1u << (x0 >> 3));
 
-					ch1 <<= 1; ch2 <<= 1;
-				}
-			}
+	for (y0 >>= 3; y0 <= (y1 >> 3); y0++)
+		tile_dirty[y0] |= columns;
+}
 
-			u64 data = ((u64) (data32 & 0x33333333)) << shift;
+/* The tiles covered by a sprite at (x, y), clipped to the screen. */
+static inline void
+mark_sprite(Uint16 x, Uint16 y)
+{
+	if (x >= PPU_TILES_WIDTH * 8 || y >= PPU_TILES_HEIGHT * 8)
+		return;
+	if (!((x | y) & 7)) {
+		tile_dirty[y >> 3] |= 1u << (x >> 3);
+		return;
+	}
+	mark_dirty(x, y, x + 7 < PPU_TILES_WIDTH * 8 ? x + 7 : PPU_TILES_WIDTH * 8 - 1,
+		y + 7 < PPU_TILES_HEIGHT * 8 ? y + 7 : PPU_TILES_HEIGHT * 8 - 1);
+}
 
-			layerptr[0] = (layerptr[0] & mask) | data;
-			if (xrightedge) layerptr[8] = (layerptr[8] & (mask >> 32)) | (data >> 32);
+ITCM_ARM_CODE
+void
+ppu_1bpp(Ppu *p, Uint8 layer, Uint16 x, Uint16 y, Uint8 *sprite, Uint8 color, Uint8 flipx, Uint8 flipy)
+{
+	blit_1bpp(p, layer, x, y, sprite, color, flipx, flipy);
+	mark_sprite(x, y);
+}
 
-			if (((y + v) & 7) == 7) layerptr += (PPU_TILES_WIDTH - 1) * 8;
-		}
-	} else {
-		for (v = 0; v < 8; v++, layerptr++) {
-			if ((y + v) >= (PPU_TILES_HEIGHT * 8)) break;
-
-			Uint8 ch1 = sprite[v ^ flipy];
-			Uint8 ch2 = sprite[(v ^ flipy) | 8];
-			u32 data32 = 0;
-			u32 mask32 = 0;
-
-			if (!flipx) {
-				for (h = 0; h < 8; h++) {
-					data32 <<= 4; mask32 <<= 4;
-
-					if ((ch1 | ch2) & 1) {
-						Uint8 ch = (ch1 & 1) | ((ch2 & 1) << 1);
-						data32 |= blending[ch][color];
-						mask32 |= 0xF;
-					}
-
-					ch1 >>= 1; ch2 >>= 1;
-				}
-			} else {
-				for (h = 0; h < 8; h++) {
-					data32 <<= 4; mask32 <<= 4;
-
-					if ((ch1 | ch2) & 128) {
-						Uint8 ch = (ch1 >> 7) | ((ch2 >> 7) << 1);
-						data32 |= blending[ch][color];
-						mask32 |= 0xF;
-					}
-
-					ch1 <<= 1; ch2 <<= 1;
-				}
-			}
-
-			u64 data = ((u64) (data32 & 0x33333333)) << shift;
-			u64 mask = ~(((u64) (mask32 & 0x33333333)) << shift);
-
-			layerptr[0] = (layerptr[0] & mask) | data;
-			if (xrightedge) layerptr[8] = (layerptr[8] & (mask >> 32)) | (data >> 32);
-
-			if (((y + v) & 7) == 7) layerptr += (PPU_TILES_WIDTH - 1) * 8;
-		}
-	}
+#ifndef DEBUG
+ITCM_ARM_CODE
+#endif
+void
+ppu_2bpp(Ppu *p, Uint8 layer, Uint16 x, Uint16 y, Uint8 *sprite, Uint8 color, Uint8 flipx, Uint8 flipy)
+{
+	blit_2bpp(p, layer, x, y, sprite, color, flipx, flipy);
+	mark_sprite(x, y);
+}
 
-	tile_dirty[y >> 3] |= dirtyflag;
-	tile_dirty[(y + 7) >> 3] |= dirtyflag;
+/* Draws count sprites in a line, each dx and dy pixels from the one before
+   and read step bytes further on in ram, wrapping around as uxn addresses
+   do. The tiles under the line are marked once, at the end. */
+#ifndef DEBUG
+ITCM_ARM_CODE
+#endif
+void
+ppu_sprites(Ppu *p, Uint8 layer, Uint16 x, Uint16 y, Sint16 dx, Sint16 dy, Uint8 *ram, Uint16 addr, Uint16 step, Uint16 count, Uint8 color, Uint8 flipx, Uint8 flipy, Uint8 twobpp)
+{
+	Uint16 i, x0 = 0xffff, y0 = 0xffff, x1 = 0, y1 = 0;
+
+	for (i = 0; i < count; i++, x += dx, y += dy, addr += step) {
+		if (twobpp)
+			blit_2bpp(p, layer, x, y, &ram[addr], color, flipx, flipy);
+		else
+			blit_1bpp(p, layer, x, y, &ram[addr], color, flipx, flipy);
+		if (x >= PPU_TILES_WIDTH * 8 || y >= PPU_TILES_HEIGHT * 8)
+			continue;
+		if (x < x0) x0 = x;
+		if (y < y0) y0 = y;
+		if (x > x1) x1 = x;
+		if (y > y1) y1 = y;
+	}
+	if (x0 == 0xffff)
+		return;
+	mark_dirty(x0, y0, x1 + 7 < PPU_TILES_WIDTH * 8 ? x1 + 7 : PPU_TILES_WIDTH * 8 - 1,
+		y1 + 7 < PPU_TILES_HEIGHT * 8 ? y1 + 7 : PPU_TILES_HEIGHT * 8 - 1);
 }
 
 /* output */
@@ -291,41 +356,100 @@ typedef struct {
 static inline void
 copytile(TileBackup *tptr)
 {
-	TileBackup *tdstptr = (TileBackup*) (((u32) tptr) & 0xFFFEFFFF);
+	TileBackup *tdstptr = (TileBackup*) (((uintptr_t) tptr) & ~(uintptr_t)0x10000);
 	*tdstptr = *tptr;
 }
 
+/* Runs of at least this many tiles are copied by DMA, which takes longer to
+   set up than a few ldm/stm pairs but moves the words faster. */
+#ifndef COPY_DMA_TILES
+#define COPY_DMA_TILES 4
+#endif
+
+/* Copies count tiles from tptr on, which follow each other in both the back
+   buffer and the displayed tiles. */
+static inline void
+copyrun(Uint32 *tptr, int count)
+{
+	if (count >= COPY_DMA_TILES) {
+		dmaCopyWords(3, tptr, (void*) (((uintptr_t) tptr) & ~(uintptr_t)0x10000), count * sizeof(TileBackup));
+		return;
+	}
+	for (; count > 0; count--, tptr += 8)
+		copytile((TileBackup*) tptr);
+}
+
+#if defined(UXNDS_HOST) || defined(DEBUG_PROFILE)
+Uint32 ppu_tiles_copied, ppu_bytes_copied;
+#endif
+#ifdef UXNDS_HOST
+Uint32 ppu_sprites_drawn;
+#endif
+
+/* The dirty tiles of each row are copied in runs of neighbours. */
 ITCM_ARM_CODE
 void
 copyppu(Ppu *p)
 {
-	int i, k, ofs;
+	int i, k, n, ofs;
+	Uint32 dirty, rest;
 
 	for (i = 0; i < 24; i++) {
-		if (tile_dirty[i] != 0) {
-			while ((k = __builtin_ffs(tile_dirty[i])) > 0) {
-				k--;
-				ofs = (i << 8) | (k << 3);
-				copytile((TileBackup*) (p->bg + ofs));
-				copytile((TileBackup*) (p->fg + ofs));
-				tile_dirty[i] ^= (1 << k);
-			}
+		dirty = tile_dirty[i];
+		while ((k = __builtin_ffs(dirty)) > 0) {
+			k--;
+			rest = ~(dirty >> k);
+			n = rest ? __builtin_ctz(rest) : 32 - k;
+			ofs = (i << 8) | (k << 3);
+			copyrun(p->bg + ofs, n);
+#ifndef PPU_PACKED
+			copyrun(p->fg + ofs, n);
+#endif
+			dirty &= ~((0xFFFFFFFF >> (32 - n)) << k);
+#if defined(UXNDS_HOST) || defined(DEBUG_PROFILE)
+			ppu_tiles_copied += n;
+#ifdef PPU_PACKED
+			ppu_bytes_copied += n * sizeof(TileBackup);
+#else
+			ppu_bytes_copied += n * sizeof(TileBackup) * 2;
+#endif
+#endif
 		}
+		tile_dirty[i] = 0;
 	}
 }
 
+int
+ppu_dirty(void)
+{
+	int i;
+
+	for (i = 0; i < 24; i++)
+		if (tile_dirty[i] != 0)
+			return 1;
+	return 0;
+}
+
 int
 initppu(Ppu *p)
 {
 	int i;
 	u16 *map_ptr;
 
+#ifdef PPU_PACKED
+	videoSetMode(DISPLAY_BG0_ACTIVE | MODE_0_2D);
+#else
 	videoSetMode(DISPLAY_BG0_ACTIVE | DISPLAY_BG1_ACTIVE | MODE_0_2D);
+#endif
 	vramSetBankA(VRAM_A_MAIN_BG);
 
 	// clear tile data
 	p->bg = (Uint32*) BG_TILE_RAM(4);
+#ifdef PPU_PACKED
+	p->fg = p->bg;
+#else
 	p->fg = (Uint32*) BG_TILE_RAM(6);
+#endif
 	for (i = 0; i < 8; i += 2) {
 		dmaFillWords(0, BG_TILE_RAM(i), (PPU_TILES_WIDTH * PPU_TILES_HEIGHT) * 32);
 	}
@@ -338,7 +462,9 @@ initppu(Ppu *p)
 	}
 
 	REG_BG0CNT = BG_32x32 | BG_COLOR_16 | BG_PRIORITY_3 | BG_TILE_BASE(0) | BG_MAP_BASE(12);
+#ifndef PPU_PACKED
 	REG_BG1CNT = BG_32x32 | BG_COLOR_16 | BG_PRIORITY_2 | BG_TILE_BASE(2) | BG_MAP_BASE(12);
+#endif
 
 	REG_BG0HOFS = 0;
 	REG_BG0VOFS = 0;
@@ -21,15 +21,29 @@ WITH REGARD TO THIS SOFTWARE.
 
 typedef unsigned char Uint8;
 typedef unsigned short Uint16;
+typedef signed short Sint16;
 typedef unsigned int Uint32;
 
+/* The back buffers of the layers, bg being layer 0 and fg layer 1. With
+   PPU_PACKED, both are one tile set holding bg in bits 0-1 of each pixel and
+   fg in bits 2-3, shown on one hardware layer through a 16-color palette. */
 typedef struct Ppu {
 	Uint32 *bg, *fg;
 } Ppu;
 
 int initppu(Ppu *p);
 void putcolors(Ppu *p, Uint8 *addr);
-void ppu_pixel(Ppu *p, Uint32 *layer, Uint16 x, Uint16 y, Uint8 color);
-void ppu_2bpp(Ppu *p, Uint32 *layer, Uint16 x, Uint16 y, Uint8 *sprite, Uint8 color, Uint8 flipx, Uint8 flipy);
-void ppu_1bpp(Ppu *p, Uint32 *layer, Uint16 x, Uint16 y, Uint8 *sprite, Uint8 color, Uint8 flipx, Uint8 flipy);
+void ppu_pixel(Ppu *p, Uint8 layer, Uint16 x, Uint16 y, Uint8 color);
+void ppu_fill(Ppu *p, Uint8 layer, Uint16 x1, Uint16 y1, Uint16 x2, Uint16 y2, Uint8 color);
+void ppu_2bpp(Ppu *p, Uint8 layer, Uint16 x, Uint16 y, Uint8 *sprite, Uint8 color, Uint8 flipx, Uint8 flipy);
+void ppu_1bpp(Ppu *p, Uint8 layer, Uint16 x, Uint16 y, Uint8 *sprite, Uint8 color, Uint8 flipx, Uint8 flipy);
+void ppu_sprites(Ppu *p, Uint8 layer, Uint16 x, Uint16 y, Sint16 dx, Sint16 dy, Uint8 *ram, Uint16 addr, Uint16 step, Uint16 count, Uint8 color, Uint8 flipx, Uint8 flipy, Uint8 twobpp);
 void copyppu(Ppu *p);
+int ppu_dirty(void);
+
+#if defined(UXNDS_HOST) || defined(DEBUG_PROFILE)
+extern Uint32 ppu_tiles_copied, ppu_bytes_copied;
+#endif
+#ifdef UXNDS_HOST
+extern Uint32 ppu_sprites_drawn;
+#endif
@@ -1,8 +1,11 @@
 #include <stdio.h>
 #include "../../include/uxn.h"
+#include "uxnfuse.h"
 
 #ifndef CPU_ERROR_CHECKING
 #define NO_STACK_CHECKS
+#else
+#define BLOCK_CACHE
 #endif
 
 /*
@@ -18,4009 +21,401 @@ WITH REGARD TO THIS SOFTWARE.
 */
 
 /*
- ^
-/!\ THIS FILE IS AUTOMATICALLY GENERATED
----
-
-Its contents can get overwritten with the processed contents of src/uxn.c.
-See etc/mkuxn-fast.moon for instructions.
-
-*/
-
-#define MODE_RETURN 0x40
-#define MODE_KEEP 0x80
-
-#pragma mark - Operations
-
-/* clang-format off */
-static inline int    devw8(Device *d, Uint8 a, Uint8 b) { d->dat[a & 0xf] = b; return d->talk(d, a & 0x0f, 1); }
-static inline Uint8  devr8(Device *d, Uint8 a) { d->talk(d, a & 0x0f, 0); return d->dat[a & 0xf];  }
-static inline int    devw16(Device *d, Uint8 a, Uint16 b) { return devw8(d, a, b >> 8) && devw8(d, a + 1, b); }
-
-/* clang-format on */
-
-#pragma mark - Core
-
-ITCM_ARM_CODE
-int
-evaluxn(Uxn *u, Uint16 vec)
-{
-	Uint8 instr;
-	if(!vec || u->dev[0].dat[0xf]) 
-		return 0;
-	u->ram.ptr = vec;
-	if(u->wst.ptr > 0xf8) u->wst.ptr = 0xf8;
-	while((instr = u->ram.dat[u->ram.ptr++])) {
-		switch(instr) {
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wunused-value"
-#pragma GCC diagnostic ignored "-Wunused-variable"
-		case 0x00: /* LIT */
-		case 0x80: /* LITk */
-			{
-				u->wst.dat[u->wst.ptr] = peek8(u->ram.dat, u->ram.ptr++);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr > 254, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 1;
-			}
-			break;
-		case 0x01: /* INC */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1];
-				u->wst.dat[u->wst.ptr - 1] = a + 1;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 1, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-			}
-			break;
-		case 0x02: /* POP */
-			{
-				u->wst.dat[u->wst.ptr - 1];
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 1, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-				u->wst.ptr -= 1;
-			}
-			break;
-		case 0x03: /* DUP */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1];
-				u->wst.dat[u->wst.ptr] = a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 1, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 254, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 1;
-			}
-			break;
-		case 0x04: /* NIP */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1];
-				u->wst.dat[u->wst.ptr - 2];
-				u->wst.dat[u->wst.ptr - 2] = a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-				u->wst.ptr -= 1;
-			}
-			break;
-		case 0x05: /* SWP */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2];
-				u->wst.dat[u->wst.ptr - 2] = a;
-				u->wst.dat[u->wst.ptr - 1] = b;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-			}
-			break;
-		case 0x06: /* OVR */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2];
-				u->wst.dat[u->wst.ptr] = b;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 254, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 1;
-			}
-			break;
-		case 0x07: /* ROT */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2], c = u->wst.dat[u->wst.ptr - 3];
-				u->wst.dat[u->wst.ptr - 3] = b;
-				u->wst.dat[u->wst.ptr - 2] = a;
-				u->wst.dat[u->wst.ptr - 1] = c;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 3, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-			}
-			break;
-		case 0x08: /* EQU */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2];
-				u->wst.dat[u->wst.ptr - 2] = b == a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-				u->wst.ptr -= 1;
-			}
-			break;
-		case 0x09: /* NEQ */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2];
-				u->wst.dat[u->wst.ptr - 2] = b != a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-				u->wst.ptr -= 1;
-			}
-			break;
-		case 0x0a: /* GTH */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2];
-				u->wst.dat[u->wst.ptr - 2] = b > a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-				u->wst.ptr -= 1;
-			}
-			break;
-		case 0x0b: /* LTH */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2];
-				u->wst.dat[u->wst.ptr - 2] = b < a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-				u->wst.ptr -= 1;
-			}
-			break;
-		case 0x0c: /* JMP */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1];
-				u->ram.ptr += (Sint8)a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 1, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-				u->wst.ptr -= 1;
-			}
-			break;
-		case 0x0d: /* JCN */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1];
-				if(u->wst.dat[u->wst.ptr - 2]) u->ram.ptr += (Sint8)a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-				u->wst.ptr -= 2;
-			}
-			break;
-		case 0x0e: /* JSR */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1];
-				u->rst.dat[u->rst.ptr] = u->ram.ptr >> 8;
-				u->rst.dat[u->rst.ptr + 1] = u->ram.ptr & 0xff;
-				u->ram.ptr += (Sint8)a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 1, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-				u->wst.ptr -= 1;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr > 253, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 2;
-			}
-			break;
-		case 0x0f: /* STH */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1];
-				u->rst.dat[u->rst.ptr] = a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 1, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-				u->wst.ptr -= 1;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr > 254, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 1;
-			}
-			break;
-		case 0x10: /* LDZ */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1];
-				u->wst.dat[u->wst.ptr - 1] = peek8(u->ram.dat, a);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 1, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-			}
-			break;
-		case 0x11: /* STZ */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1];
-				Uint8 b = u->wst.dat[u->wst.ptr - 2];
-				poke8(u->ram.dat, a, b);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-				u->wst.ptr -= 2;
-			}
-			break;
-		case 0x12: /* LDR */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1];
-				u->wst.dat[u->wst.ptr - 1] = peek8(u->ram.dat, u->ram.ptr + (Sint8)a);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 1, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-			}
-			break;
-		case 0x13: /* STR */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1];
-				Uint8 b = u->wst.dat[u->wst.ptr - 2];
-				poke8(u->ram.dat, u->ram.ptr + (Sint8)a, b);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-				u->wst.ptr -= 2;
-			}
-			break;
-		case 0x14: /* LDA */
-			{
-				Uint16 a = (u->wst.dat[u->wst.ptr - 1] | (u->wst.dat[u->wst.ptr - 2] << 8));
-				u->wst.dat[u->wst.ptr - 2] = peek8(u->ram.dat, a);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-				u->wst.ptr -= 1;
-			}
-			break;
-		case 0x15: /* STA */
-			{
-				Uint16 a = (u->wst.dat[u->wst.ptr - 1] | (u->wst.dat[u->wst.ptr - 2] << 8));
-				Uint8 b = u->wst.dat[u->wst.ptr - 3];
-				poke8(u->ram.dat, a, b);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 3, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-				u->wst.ptr -= 3;
-			}
-			break;
-		case 0x16: /* DEI */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1];
-				u->wst.dat[u->wst.ptr - 1] = devr8(&u->dev[a >> 4], a);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 1, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-			}
-			break;
-		case 0x17: /* DEO */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2];
-				if(!devw8(&u->dev[a >> 4], a, b))
-					return 1;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-				u->wst.ptr -= 2;
-			}
-			break;
-		case 0x18: /* ADD */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2];
-				u->wst.dat[u->wst.ptr - 2] = b + a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-				u->wst.ptr -= 1;
-			}
-			break;
-		case 0x19: /* SUB */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2];
-				u->wst.dat[u->wst.ptr - 2] = b - a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-				u->wst.ptr -= 1;
-			}
-			break;
-		case 0x1a: /* MUL */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2];
-				u->wst.dat[u->wst.ptr - 2] = b * a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-				u->wst.ptr -= 1;
-			}
-			break;
-		case 0x1b: /* DIV */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2];
-				if(a == 0) {
-					u->wst.error = 3;
-#ifndef NO_STACK_CHECKS
-					goto error;
-#endif
-					a = 1;
-				}
-				u->wst.dat[u->wst.ptr - 2] = b / a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-				u->wst.ptr -= 1;
-			}
-			break;
-		case 0x1c: /* AND */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2];
-				u->wst.dat[u->wst.ptr - 2] = b & a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-				u->wst.ptr -= 1;
-			}
-			break;
-		case 0x1d: /* ORA */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2];
-				u->wst.dat[u->wst.ptr - 2] = b | a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-				u->wst.ptr -= 1;
-			}
-			break;
-		case 0x1e: /* EOR */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2];
-				u->wst.dat[u->wst.ptr - 2] = b ^ a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-				u->wst.ptr -= 1;
-			}
-			break;
-		case 0x1f: /* SFT */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2];
-				u->wst.dat[u->wst.ptr - 2] = b >> (a & 0x07) << ((a & 0x70) >> 4);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-				u->wst.ptr -= 1;
-			}
-			break;
-		case 0x20: /* LIT2 */
-		case 0xa0: /* LIT2k */
-			{
-				u->wst.dat[u->wst.ptr] = peek8(u->ram.dat, u->ram.ptr++);
-				u->wst.dat[u->wst.ptr + 1] = peek8(u->ram.dat, u->ram.ptr++);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr > 253, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 2;
-			}
-			break;
-		case 0x21: /* INC2 */
-			{
-				Uint16 a = (u->wst.dat[u->wst.ptr - 1] | (u->wst.dat[u->wst.ptr - 2] << 8));
-				u->wst.dat[u->wst.ptr - 2] = (a + 1) >> 8;
-				u->wst.dat[u->wst.ptr - 1] = (a + 1) & 0xff;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-			}
-			break;
-		case 0x22: /* POP2 */
-			{
-				(u->wst.dat[u->wst.ptr - 1] | (u->wst.dat[u->wst.ptr - 2] << 8));
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-				u->wst.ptr -= 2;
-			}
-			break;
-		case 0x23: /* DUP2 */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2];
-				u->wst.dat[u->wst.ptr] = b;
-				u->wst.dat[u->wst.ptr + 1] = a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 253, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 2;
-			}
-			break;
-		case 0x24: /* NIP2 */
-			{
-				Uint16 a = (u->wst.dat[u->wst.ptr - 1] | (u->wst.dat[u->wst.ptr - 2] << 8));
-				(u->wst.dat[u->wst.ptr - 3] | (u->wst.dat[u->wst.ptr - 4] << 8));
-				u->wst.dat[u->wst.ptr - 4] = a >> 8;
-				u->wst.dat[u->wst.ptr - 3] = a & 0xff;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 4, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-				u->wst.ptr -= 2;
-			}
-			break;
-		case 0x25: /* SWP2 */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2], c = u->wst.dat[u->wst.ptr - 3], d = u->wst.dat[u->wst.ptr - 4];
-				u->wst.dat[u->wst.ptr - 4] = b;
-				u->wst.dat[u->wst.ptr - 3] = a;
-				u->wst.dat[u->wst.ptr - 2] = d;
-				u->wst.dat[u->wst.ptr - 1] = c;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 4, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-			}
-			break;
-		case 0x26: /* OVR2 */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2], c = u->wst.dat[u->wst.ptr - 3], d = u->wst.dat[u->wst.ptr - 4];
-				u->wst.dat[u->wst.ptr] = d;
-				u->wst.dat[u->wst.ptr + 1] = c;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 4, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 253, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 2;
-			}
-			break;
-		case 0x27: /* ROT2 */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2], c = u->wst.dat[u->wst.ptr - 3], d = u->wst.dat[u->wst.ptr - 4], e = u->wst.dat[u->wst.ptr - 5], f = u->wst.dat[u->wst.ptr - 6];
-				u->wst.dat[u->wst.ptr - 6] = d;
-				u->wst.dat[u->wst.ptr - 5] = c;
-				u->wst.dat[u->wst.ptr - 4] = b;
-				u->wst.dat[u->wst.ptr - 3] = a;
-				u->wst.dat[u->wst.ptr - 2] = f;
-				u->wst.dat[u->wst.ptr - 1] = e;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 6, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-			}
-			break;
-		case 0x28: /* EQU2 */
-			{
-				Uint16 a = (u->wst.dat[u->wst.ptr - 1] | (u->wst.dat[u->wst.ptr - 2] << 8)), b = (u->wst.dat[u->wst.ptr - 3] | (u->wst.dat[u->wst.ptr - 4] << 8));
-				u->wst.dat[u->wst.ptr - 4] = b == a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 4, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-				u->wst.ptr -= 3;
-			}
-			break;
-		case 0x29: /* NEQ2 */
-			{
-				Uint16 a = (u->wst.dat[u->wst.ptr - 1] | (u->wst.dat[u->wst.ptr - 2] << 8)), b = (u->wst.dat[u->wst.ptr - 3] | (u->wst.dat[u->wst.ptr - 4] << 8));
-				u->wst.dat[u->wst.ptr - 4] = b != a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 4, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-				u->wst.ptr -= 3;
-			}
-			break;
-		case 0x2a: /* GTH2 */
-			{
-				Uint16 a = (u->wst.dat[u->wst.ptr - 1] | (u->wst.dat[u->wst.ptr - 2] << 8)), b = (u->wst.dat[u->wst.ptr - 3] | (u->wst.dat[u->wst.ptr - 4] << 8));
-				u->wst.dat[u->wst.ptr - 4] = b > a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 4, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-				u->wst.ptr -= 3;
-			}
-			break;
-		case 0x2b: /* LTH2 */
-			{
-				Uint16 a = (u->wst.dat[u->wst.ptr - 1] | (u->wst.dat[u->wst.ptr - 2] << 8)), b = (u->wst.dat[u->wst.ptr - 3] | (u->wst.dat[u->wst.ptr - 4] << 8));
-				u->wst.dat[u->wst.ptr - 4] = b < a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 4, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-				u->wst.ptr -= 3;
-			}
-			break;
-		case 0x2c: /* JMP2 */
-			{
-				u->ram.ptr = (u->wst.dat[u->wst.ptr - 1] | (u->wst.dat[u->wst.ptr - 2] << 8));
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-				u->wst.ptr -= 2;
-			}
-			break;
-		case 0x2d: /* JCN2 */
-			{
-				Uint16 a = (u->wst.dat[u->wst.ptr - 1] | (u->wst.dat[u->wst.ptr - 2] << 8));
-				if(u->wst.dat[u->wst.ptr - 3]) u->ram.ptr = a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 3, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-				u->wst.ptr -= 3;
-			}
-			break;
-		case 0x2e: /* JSR2 */
-			{
-				u->rst.dat[u->rst.ptr] = u->ram.ptr >> 8;
-				u->rst.dat[u->rst.ptr + 1] = u->ram.ptr & 0xff;
-				u->ram.ptr = (u->wst.dat[u->wst.ptr - 1] | (u->wst.dat[u->wst.ptr - 2] << 8));
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-				u->wst.ptr -= 2;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr > 253, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 2;
-			}
-			break;
-		case 0x2f: /* STH2 */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2];
-				u->rst.dat[u->rst.ptr] = b;
-				u->rst.dat[u->rst.ptr + 1] = a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-				u->wst.ptr -= 2;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr > 253, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 2;
-			}
-			break;
-		case 0x30: /* LDZ2 */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1];
-				u->wst.dat[u->wst.ptr - 1] = peek8(u->ram.dat, a);
-				u->wst.dat[u->wst.ptr] = peek8(u->ram.dat, a + 1);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 1, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 254, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 1;
-			}
-			break;
-		case 0x31: /* STZ2 */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1];
-				Uint16 b = (u->wst.dat[u->wst.ptr - 2] | (u->wst.dat[u->wst.ptr - 3] << 8));
-				poke16(u->ram.dat, a, b);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 3, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-				u->wst.ptr -= 3;
-			}
-			break;
-		case 0x32: /* LDR2 */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1];
-				u->wst.dat[u->wst.ptr - 1] = peek8(u->ram.dat, u->ram.ptr + (Sint8)a);
-				u->wst.dat[u->wst.ptr] = peek8(u->ram.dat, u->ram.ptr + (Sint8)a + 1);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 1, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 254, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 1;
-			}
-			break;
-		case 0x33: /* STR2 */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1];
-				Uint16 b = (u->wst.dat[u->wst.ptr - 2] | (u->wst.dat[u->wst.ptr - 3] << 8));
-				poke16(u->ram.dat, u->ram.ptr + (Sint8)a, b);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 3, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-				u->wst.ptr -= 3;
-			}
-			break;
-		case 0x34: /* LDA2 */
-			{
-				Uint16 a = (u->wst.dat[u->wst.ptr - 1] | (u->wst.dat[u->wst.ptr - 2] << 8));
-				u->wst.dat[u->wst.ptr - 2] = peek8(u->ram.dat, a);
-				u->wst.dat[u->wst.ptr - 1] = peek8(u->ram.dat, a + 1);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-			}
-			break;
-		case 0x35: /* STA2 */
-			{
-				Uint16 a = (u->wst.dat[u->wst.ptr - 1] | (u->wst.dat[u->wst.ptr - 2] << 8));
-				Uint16 b = (u->wst.dat[u->wst.ptr - 3] | (u->wst.dat[u->wst.ptr - 4] << 8));
-				poke16(u->ram.dat, a, b);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 4, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-				u->wst.ptr -= 4;
-			}
-			break;
-		case 0x36: /* DEI2 */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1];
-				u->wst.dat[u->wst.ptr - 1] = devr8(&u->dev[a >> 4], a);
-				u->wst.dat[u->wst.ptr] = devr8(&u->dev[a >> 4], a + 1);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 1, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 254, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 1;
-			}
-			break;
-		case 0x37: /* DEO2 */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1];
-				Uint16 b = (u->wst.dat[u->wst.ptr - 2] | (u->wst.dat[u->wst.ptr - 3] << 8));
-				if(!devw16(&u->dev[a >> 4], a, b))
-					return 1;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 3, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-				u->wst.ptr -= 3;
-			}
-			break;
-		case 0x38: /* ADD2 */
-			{
-				Uint16 a = (u->wst.dat[u->wst.ptr - 1] | (u->wst.dat[u->wst.ptr - 2] << 8)), b = (u->wst.dat[u->wst.ptr - 3] | (u->wst.dat[u->wst.ptr - 4] << 8));
-				u->wst.dat[u->wst.ptr - 4] = (b + a) >> 8;
-				u->wst.dat[u->wst.ptr - 3] = (b + a) & 0xff;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 4, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-				u->wst.ptr -= 2;
-			}
-			break;
-		case 0x39: /* SUB2 */
-			{
-				Uint16 a = (u->wst.dat[u->wst.ptr - 1] | (u->wst.dat[u->wst.ptr - 2] << 8)), b = (u->wst.dat[u->wst.ptr - 3] | (u->wst.dat[u->wst.ptr - 4] << 8));
-				u->wst.dat[u->wst.ptr - 4] = (b - a) >> 8;
-				u->wst.dat[u->wst.ptr - 3] = (b - a) & 0xff;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 4, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-				u->wst.ptr -= 2;
-			}
-			break;
-		case 0x3a: /* MUL2 */
-			{
-				Uint16 a = (u->wst.dat[u->wst.ptr - 1] | (u->wst.dat[u->wst.ptr - 2] << 8)), b = (u->wst.dat[u->wst.ptr - 3] | (u->wst.dat[u->wst.ptr - 4] << 8));
-				u->wst.dat[u->wst.ptr - 4] = (b * a) >> 8;
-				u->wst.dat[u->wst.ptr - 3] = (b * a) & 0xff;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 4, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-				u->wst.ptr -= 2;
-			}
-			break;
-		case 0x3b: /* DIV2 */
-			{
-				Uint16 a = (u->wst.dat[u->wst.ptr - 1] | (u->wst.dat[u->wst.ptr - 2] << 8)), b = (u->wst.dat[u->wst.ptr - 3] | (u->wst.dat[u->wst.ptr - 4] << 8));
-				if(a == 0) {
-					u->wst.error = 3;
-#ifndef NO_STACK_CHECKS
-					goto error;
-#endif
-					a = 1;
-				}
-				u->wst.dat[u->wst.ptr - 4] = (b / a) >> 8;
-				u->wst.dat[u->wst.ptr - 3] = (b / a) & 0xff;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 4, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-				u->wst.ptr -= 2;
-			}
-			break;
-		case 0x3c: /* AND2 */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2], c = u->wst.dat[u->wst.ptr - 3], d = u->wst.dat[u->wst.ptr - 4];
-				u->wst.dat[u->wst.ptr - 4] = d & b;
-				u->wst.dat[u->wst.ptr - 3] = c & a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 4, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-				u->wst.ptr -= 2;
-			}
-			break;
-		case 0x3d: /* ORA2 */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2], c = u->wst.dat[u->wst.ptr - 3], d = u->wst.dat[u->wst.ptr - 4];
-				u->wst.dat[u->wst.ptr - 4] = d | b;
-				u->wst.dat[u->wst.ptr - 3] = c | a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 4, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-				u->wst.ptr -= 2;
-			}
-			break;
-		case 0x3e: /* EOR2 */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2], c = u->wst.dat[u->wst.ptr - 3], d = u->wst.dat[u->wst.ptr - 4];
-				u->wst.dat[u->wst.ptr - 4] = d ^ b;
-				u->wst.dat[u->wst.ptr - 3] = c ^ a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 4, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-				u->wst.ptr -= 2;
-			}
-			break;
-		case 0x3f: /* SFT2 */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1];
-				Uint16 b = (u->wst.dat[u->wst.ptr - 2] | (u->wst.dat[u->wst.ptr - 3] << 8));
-				u->wst.dat[u->wst.ptr - 3] = (b >> (a & 0x0f) << ((a & 0xf0) >> 4)) >> 8;
-				u->wst.dat[u->wst.ptr - 2] = (b >> (a & 0x0f) << ((a & 0xf0) >> 4)) & 0xff;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 3, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-				u->wst.ptr -= 1;
-			}
-			break;
-		case 0x40: /* LITr */
-		case 0xc0: /* LITkr */
-			{
-				u->rst.dat[u->rst.ptr] = peek8(u->ram.dat, u->ram.ptr++);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr > 254, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 1;
-			}
-			break;
-		case 0x41: /* INCr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1];
-				u->rst.dat[u->rst.ptr - 1] = a + 1;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 1, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-			}
-			break;
-		case 0x42: /* POPr */
-			{
-				u->rst.dat[u->rst.ptr - 1];
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 1, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-				u->rst.ptr -= 1;
-			}
-			break;
-		case 0x43: /* DUPr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1];
-				u->rst.dat[u->rst.ptr] = a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 1, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 254, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 1;
-			}
-			break;
-		case 0x44: /* NIPr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1];
-				u->rst.dat[u->rst.ptr - 2];
-				u->rst.dat[u->rst.ptr - 2] = a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-				u->rst.ptr -= 1;
-			}
-			break;
-		case 0x45: /* SWPr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2];
-				u->rst.dat[u->rst.ptr - 2] = a;
-				u->rst.dat[u->rst.ptr - 1] = b;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-			}
-			break;
-		case 0x46: /* OVRr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2];
-				u->rst.dat[u->rst.ptr] = b;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 254, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 1;
-			}
-			break;
-		case 0x47: /* ROTr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2], c = u->rst.dat[u->rst.ptr - 3];
-				u->rst.dat[u->rst.ptr - 3] = b;
-				u->rst.dat[u->rst.ptr - 2] = a;
-				u->rst.dat[u->rst.ptr - 1] = c;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 3, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-			}
-			break;
-		case 0x48: /* EQUr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2];
-				u->rst.dat[u->rst.ptr - 2] = b == a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-				u->rst.ptr -= 1;
-			}
-			break;
-		case 0x49: /* NEQr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2];
-				u->rst.dat[u->rst.ptr - 2] = b != a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-				u->rst.ptr -= 1;
-			}
-			break;
-		case 0x4a: /* GTHr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2];
-				u->rst.dat[u->rst.ptr - 2] = b > a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-				u->rst.ptr -= 1;
-			}
-			break;
-		case 0x4b: /* LTHr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2];
-				u->rst.dat[u->rst.ptr - 2] = b < a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-				u->rst.ptr -= 1;
-			}
-			break;
-		case 0x4c: /* JMPr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1];
-				u->ram.ptr += (Sint8)a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 1, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-				u->rst.ptr -= 1;
-			}
-			break;
-		case 0x4d: /* JCNr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1];
-				if(u->rst.dat[u->rst.ptr - 2]) u->ram.ptr += (Sint8)a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-				u->rst.ptr -= 2;
-			}
-			break;
-		case 0x4e: /* JSRr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1];
-				u->wst.dat[u->wst.ptr] = u->ram.ptr >> 8;
-				u->wst.dat[u->wst.ptr + 1] = u->ram.ptr & 0xff;
-				u->ram.ptr += (Sint8)a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 1, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-				u->rst.ptr -= 1;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr > 253, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 2;
-			}
-			break;
-		case 0x4f: /* STHr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1];
-				u->wst.dat[u->wst.ptr] = a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 1, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-				u->rst.ptr -= 1;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr > 254, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 1;
-			}
-			break;
-		case 0x50: /* LDZr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1];
-				u->rst.dat[u->rst.ptr - 1] = peek8(u->ram.dat, a);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 1, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-			}
-			break;
-		case 0x51: /* STZr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1];
-				Uint8 b = u->rst.dat[u->rst.ptr - 2];
-				poke8(u->ram.dat, a, b);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-				u->rst.ptr -= 2;
-			}
-			break;
-		case 0x52: /* LDRr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1];
-				u->rst.dat[u->rst.ptr - 1] = peek8(u->ram.dat, u->ram.ptr + (Sint8)a);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 1, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-			}
-			break;
-		case 0x53: /* STRr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1];
-				Uint8 b = u->rst.dat[u->rst.ptr - 2];
-				poke8(u->ram.dat, u->ram.ptr + (Sint8)a, b);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-				u->rst.ptr -= 2;
-			}
-			break;
-		case 0x54: /* LDAr */
-			{
-				Uint16 a = (u->rst.dat[u->rst.ptr - 1] | (u->rst.dat[u->rst.ptr - 2] << 8));
-				u->rst.dat[u->rst.ptr - 2] = peek8(u->ram.dat, a);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-				u->rst.ptr -= 1;
-			}
-			break;
-		case 0x55: /* STAr */
-			{
-				Uint16 a = (u->rst.dat[u->rst.ptr - 1] | (u->rst.dat[u->rst.ptr - 2] << 8));
-				Uint8 b = u->rst.dat[u->rst.ptr - 3];
-				poke8(u->ram.dat, a, b);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 3, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-				u->rst.ptr -= 3;
-			}
-			break;
-		case 0x56: /* DEIr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1];
-				u->rst.dat[u->rst.ptr - 1] = devr8(&u->dev[a >> 4], a);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 1, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-			}
-			break;
-		case 0x57: /* DEOr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2];
-				if(!devw8(&u->dev[a >> 4], a, b))
-					return 1;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-				u->rst.ptr -= 2;
-			}
-			break;
-		case 0x58: /* ADDr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2];
-				u->rst.dat[u->rst.ptr - 2] = b + a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-				u->rst.ptr -= 1;
-			}
-			break;
-		case 0x59: /* SUBr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2];
-				u->rst.dat[u->rst.ptr - 2] = b - a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-				u->rst.ptr -= 1;
-			}
-			break;
-		case 0x5a: /* MULr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2];
-				u->rst.dat[u->rst.ptr - 2] = b * a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-				u->rst.ptr -= 1;
-			}
-			break;
-		case 0x5b: /* DIVr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2];
-				if(a == 0) {
-					u->rst.error = 3;
-#ifndef NO_STACK_CHECKS
-					goto error;
-#endif
-					a = 1;
-				}
-				u->rst.dat[u->rst.ptr - 2] = b / a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-				u->rst.ptr -= 1;
-			}
-			break;
-		case 0x5c: /* ANDr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2];
-				u->rst.dat[u->rst.ptr - 2] = b & a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-				u->rst.ptr -= 1;
-			}
-			break;
-		case 0x5d: /* ORAr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2];
-				u->rst.dat[u->rst.ptr - 2] = b | a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-				u->rst.ptr -= 1;
-			}
-			break;
-		case 0x5e: /* EORr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2];
-				u->rst.dat[u->rst.ptr - 2] = b ^ a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-				u->rst.ptr -= 1;
-			}
-			break;
-		case 0x5f: /* SFTr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2];
-				u->rst.dat[u->rst.ptr - 2] = b >> (a & 0x07) << ((a & 0x70) >> 4);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-				u->rst.ptr -= 1;
-			}
-			break;
-		case 0x60: /* LIT2r */
-		case 0xe0: /* LIT2kr */
-			{
-				u->rst.dat[u->rst.ptr] = peek8(u->ram.dat, u->ram.ptr++);
-				u->rst.dat[u->rst.ptr + 1] = peek8(u->ram.dat, u->ram.ptr++);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr > 253, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 2;
-			}
-			break;
-		case 0x61: /* INC2r */
-			{
-				Uint16 a = (u->rst.dat[u->rst.ptr - 1] | (u->rst.dat[u->rst.ptr - 2] << 8));
-				u->rst.dat[u->rst.ptr - 2] = (a + 1) >> 8;
-				u->rst.dat[u->rst.ptr - 1] = (a + 1) & 0xff;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-			}
-			break;
-		case 0x62: /* POP2r */
-			{
-				(u->rst.dat[u->rst.ptr - 1] | (u->rst.dat[u->rst.ptr - 2] << 8));
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-				u->rst.ptr -= 2;
-			}
-			break;
-		case 0x63: /* DUP2r */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2];
-				u->rst.dat[u->rst.ptr] = b;
-				u->rst.dat[u->rst.ptr + 1] = a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 253, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 2;
-			}
-			break;
-		case 0x64: /* NIP2r */
-			{
-				Uint16 a = (u->rst.dat[u->rst.ptr - 1] | (u->rst.dat[u->rst.ptr - 2] << 8));
-				(u->rst.dat[u->rst.ptr - 3] | (u->rst.dat[u->rst.ptr - 4] << 8));
-				u->rst.dat[u->rst.ptr - 4] = a >> 8;
-				u->rst.dat[u->rst.ptr - 3] = a & 0xff;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 4, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-				u->rst.ptr -= 2;
-			}
-			break;
-		case 0x65: /* SWP2r */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2], c = u->rst.dat[u->rst.ptr - 3], d = u->rst.dat[u->rst.ptr - 4];
-				u->rst.dat[u->rst.ptr - 4] = b;
-				u->rst.dat[u->rst.ptr - 3] = a;
-				u->rst.dat[u->rst.ptr - 2] = d;
-				u->rst.dat[u->rst.ptr - 1] = c;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 4, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-			}
-			break;
-		case 0x66: /* OVR2r */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2], c = u->rst.dat[u->rst.ptr - 3], d = u->rst.dat[u->rst.ptr - 4];
-				u->rst.dat[u->rst.ptr] = d;
-				u->rst.dat[u->rst.ptr + 1] = c;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 4, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 253, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 2;
-			}
-			break;
-		case 0x67: /* ROT2r */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2], c = u->rst.dat[u->rst.ptr - 3], d = u->rst.dat[u->rst.ptr - 4], e = u->rst.dat[u->rst.ptr - 5], f = u->rst.dat[u->rst.ptr - 6];
-				u->rst.dat[u->rst.ptr - 6] = d;
-				u->rst.dat[u->rst.ptr - 5] = c;
-				u->rst.dat[u->rst.ptr - 4] = b;
-				u->rst.dat[u->rst.ptr - 3] = a;
-				u->rst.dat[u->rst.ptr - 2] = f;
-				u->rst.dat[u->rst.ptr - 1] = e;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 6, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-			}
-			break;
-		case 0x68: /* EQU2r */
-			{
-				Uint16 a = (u->rst.dat[u->rst.ptr - 1] | (u->rst.dat[u->rst.ptr - 2] << 8)), b = (u->rst.dat[u->rst.ptr - 3] | (u->rst.dat[u->rst.ptr - 4] << 8));
-				u->rst.dat[u->rst.ptr - 4] = b == a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 4, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-				u->rst.ptr -= 3;
-			}
-			break;
-		case 0x69: /* NEQ2r */
-			{
-				Uint16 a = (u->rst.dat[u->rst.ptr - 1] | (u->rst.dat[u->rst.ptr - 2] << 8)), b = (u->rst.dat[u->rst.ptr - 3] | (u->rst.dat[u->rst.ptr - 4] << 8));
-				u->rst.dat[u->rst.ptr - 4] = b != a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 4, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-				u->rst.ptr -= 3;
-			}
-			break;
-		case 0x6a: /* GTH2r */
-			{
-				Uint16 a = (u->rst.dat[u->rst.ptr - 1] | (u->rst.dat[u->rst.ptr - 2] << 8)), b = (u->rst.dat[u->rst.ptr - 3] | (u->rst.dat[u->rst.ptr - 4] << 8));
-				u->rst.dat[u->rst.ptr - 4] = b > a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 4, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-				u->rst.ptr -= 3;
-			}
-			break;
-		case 0x6b: /* LTH2r */
-			{
-				Uint16 a = (u->rst.dat[u->rst.ptr - 1] | (u->rst.dat[u->rst.ptr - 2] << 8)), b = (u->rst.dat[u->rst.ptr - 3] | (u->rst.dat[u->rst.ptr - 4] << 8));
-				u->rst.dat[u->rst.ptr - 4] = b < a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 4, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-				u->rst.ptr -= 3;
-			}
-			break;
-		case 0x6c: /* JMP2r */
-			{
-				u->ram.ptr = (u->rst.dat[u->rst.ptr - 1] | (u->rst.dat[u->rst.ptr - 2] << 8));
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-				u->rst.ptr -= 2;
-			}
-			break;
-		case 0x6d: /* JCN2r */
-			{
-				Uint16 a = (u->rst.dat[u->rst.ptr - 1] | (u->rst.dat[u->rst.ptr - 2] << 8));
-				if(u->rst.dat[u->rst.ptr - 3]) u->ram.ptr = a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 3, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-				u->rst.ptr -= 3;
-			}
-			break;
-		case 0x6e: /* JSR2r */
-			{
-				u->wst.dat[u->wst.ptr] = u->ram.ptr >> 8;
-				u->wst.dat[u->wst.ptr + 1] = u->ram.ptr & 0xff;
-				u->ram.ptr = (u->rst.dat[u->rst.ptr - 1] | (u->rst.dat[u->rst.ptr - 2] << 8));
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-				u->rst.ptr -= 2;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr > 253, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 2;
-			}
-			break;
-		case 0x6f: /* STH2r */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2];
-				u->wst.dat[u->wst.ptr] = b;
-				u->wst.dat[u->wst.ptr + 1] = a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-				u->rst.ptr -= 2;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr > 253, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 2;
-			}
-			break;
-		case 0x70: /* LDZ2r */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1];
-				u->rst.dat[u->rst.ptr - 1] = peek8(u->ram.dat, a);
-				u->rst.dat[u->rst.ptr] = peek8(u->ram.dat, a + 1);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 1, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 254, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 1;
-			}
-			break;
-		case 0x71: /* STZ2r */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1];
-				Uint16 b = (u->rst.dat[u->rst.ptr - 2] | (u->rst.dat[u->rst.ptr - 3] << 8));
-				poke16(u->ram.dat, a, b);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 3, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-				u->rst.ptr -= 3;
-			}
-			break;
-		case 0x72: /* LDR2r */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1];
-				u->rst.dat[u->rst.ptr - 1] = peek8(u->ram.dat, u->ram.ptr + (Sint8)a);
-				u->rst.dat[u->rst.ptr] = peek8(u->ram.dat, u->ram.ptr + (Sint8)a + 1);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 1, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 254, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 1;
-			}
-			break;
-		case 0x73: /* STR2r */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1];
-				Uint16 b = (u->rst.dat[u->rst.ptr - 2] | (u->rst.dat[u->rst.ptr - 3] << 8));
-				poke16(u->ram.dat, u->ram.ptr + (Sint8)a, b);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 3, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-				u->rst.ptr -= 3;
-			}
-			break;
-		case 0x74: /* LDA2r */
-			{
-				Uint16 a = (u->rst.dat[u->rst.ptr - 1] | (u->rst.dat[u->rst.ptr - 2] << 8));
-				u->rst.dat[u->rst.ptr - 2] = peek8(u->ram.dat, a);
-				u->rst.dat[u->rst.ptr - 1] = peek8(u->ram.dat, a + 1);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-			}
-			break;
-		case 0x75: /* STA2r */
-			{
-				Uint16 a = (u->rst.dat[u->rst.ptr - 1] | (u->rst.dat[u->rst.ptr - 2] << 8));
-				Uint16 b = (u->rst.dat[u->rst.ptr - 3] | (u->rst.dat[u->rst.ptr - 4] << 8));
-				poke16(u->ram.dat, a, b);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 4, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-				u->rst.ptr -= 4;
-			}
-			break;
-		case 0x76: /* DEI2r */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1];
-				u->rst.dat[u->rst.ptr - 1] = devr8(&u->dev[a >> 4], a);
-				u->rst.dat[u->rst.ptr] = devr8(&u->dev[a >> 4], a + 1);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 1, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 254, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 1;
-			}
-			break;
-		case 0x77: /* DEO2r */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1];
-				Uint16 b = (u->rst.dat[u->rst.ptr - 2] | (u->rst.dat[u->rst.ptr - 3] << 8));
-				if(!devw16(&u->dev[a >> 4], a, b))
-					return 1;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 3, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-				u->rst.ptr -= 3;
-			}
-			break;
-		case 0x78: /* ADD2r */
-			{
-				Uint16 a = (u->rst.dat[u->rst.ptr - 1] | (u->rst.dat[u->rst.ptr - 2] << 8)), b = (u->rst.dat[u->rst.ptr - 3] | (u->rst.dat[u->rst.ptr - 4] << 8));
-				u->rst.dat[u->rst.ptr - 4] = (b + a) >> 8;
-				u->rst.dat[u->rst.ptr - 3] = (b + a) & 0xff;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 4, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-				u->rst.ptr -= 2;
-			}
-			break;
-		case 0x79: /* SUB2r */
-			{
-				Uint16 a = (u->rst.dat[u->rst.ptr - 1] | (u->rst.dat[u->rst.ptr - 2] << 8)), b = (u->rst.dat[u->rst.ptr - 3] | (u->rst.dat[u->rst.ptr - 4] << 8));
-				u->rst.dat[u->rst.ptr - 4] = (b - a) >> 8;
-				u->rst.dat[u->rst.ptr - 3] = (b - a) & 0xff;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 4, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-				u->rst.ptr -= 2;
-			}
-			break;
-		case 0x7a: /* MUL2r */
-			{
-				Uint16 a = (u->rst.dat[u->rst.ptr - 1] | (u->rst.dat[u->rst.ptr - 2] << 8)), b = (u->rst.dat[u->rst.ptr - 3] | (u->rst.dat[u->rst.ptr - 4] << 8));
-				u->rst.dat[u->rst.ptr - 4] = (b * a) >> 8;
-				u->rst.dat[u->rst.ptr - 3] = (b * a) & 0xff;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 4, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-				u->rst.ptr -= 2;
-			}
-			break;
-		case 0x7b: /* DIV2r */
-			{
-				Uint16 a = (u->rst.dat[u->rst.ptr - 1] | (u->rst.dat[u->rst.ptr - 2] << 8)), b = (u->rst.dat[u->rst.ptr - 3] | (u->rst.dat[u->rst.ptr - 4] << 8));
-				if(a == 0) {
-					u->rst.error = 3;
-#ifndef NO_STACK_CHECKS
-					goto error;
-#endif
-					a = 1;
-				}
-				u->rst.dat[u->rst.ptr - 4] = (b / a) >> 8;
-				u->rst.dat[u->rst.ptr - 3] = (b / a) & 0xff;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 4, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-				u->rst.ptr -= 2;
-			}
-			break;
-		case 0x7c: /* AND2r */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2], c = u->rst.dat[u->rst.ptr - 3], d = u->rst.dat[u->rst.ptr - 4];
-				u->rst.dat[u->rst.ptr - 4] = d & b;
-				u->rst.dat[u->rst.ptr - 3] = c & a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 4, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-				u->rst.ptr -= 2;
-			}
-			break;
-		case 0x7d: /* ORA2r */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2], c = u->rst.dat[u->rst.ptr - 3], d = u->rst.dat[u->rst.ptr - 4];
-				u->rst.dat[u->rst.ptr - 4] = d | b;
-				u->rst.dat[u->rst.ptr - 3] = c | a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 4, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-				u->rst.ptr -= 2;
-			}
-			break;
-		case 0x7e: /* EOR2r */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2], c = u->rst.dat[u->rst.ptr - 3], d = u->rst.dat[u->rst.ptr - 4];
-				u->rst.dat[u->rst.ptr - 4] = d ^ b;
-				u->rst.dat[u->rst.ptr - 3] = c ^ a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 4, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-				u->rst.ptr -= 2;
-			}
-			break;
-		case 0x7f: /* SFT2r */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1];
-				Uint16 b = (u->rst.dat[u->rst.ptr - 2] | (u->rst.dat[u->rst.ptr - 3] << 8));
-				u->rst.dat[u->rst.ptr - 3] = (b >> (a & 0x0f) << ((a & 0xf0) >> 4)) >> 8;
-				u->rst.dat[u->rst.ptr - 2] = (b >> (a & 0x0f) << ((a & 0xf0) >> 4)) & 0xff;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 3, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-				u->rst.ptr -= 1;
-			}
-			break;
-		case 0x81: /* INCk */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1];
-				u->wst.dat[u->wst.ptr] = a + 1;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 1, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 254, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 1;
-			}
-			break;
-		case 0x82: /* POPk */
-			{
-				u->wst.dat[u->wst.ptr - 1];
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 1, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-			}
-			break;
-		case 0x83: /* DUPk */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1];
-				u->wst.dat[u->wst.ptr] = a;
-				u->wst.dat[u->wst.ptr + 1] = a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 1, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 253, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 2;
-			}
-			break;
-		case 0x84: /* NIPk */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1];
-				u->wst.dat[u->wst.ptr - 2];
-				u->wst.dat[u->wst.ptr] = a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 254, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 1;
-			}
-			break;
-		case 0x85: /* SWPk */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2];
-				u->wst.dat[u->wst.ptr] = a;
-				u->wst.dat[u->wst.ptr + 1] = b;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 253, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 2;
-			}
-			break;
-		case 0x86: /* OVRk */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2];
-				u->wst.dat[u->wst.ptr] = b;
-				u->wst.dat[u->wst.ptr + 1] = a;
-				u->wst.dat[u->wst.ptr + 2] = b;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 252, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 3;
-			}
-			break;
-		case 0x87: /* ROTk */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2], c = u->wst.dat[u->wst.ptr - 3];
-				u->wst.dat[u->wst.ptr] = b;
-				u->wst.dat[u->wst.ptr + 1] = a;
-				u->wst.dat[u->wst.ptr + 2] = c;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 3, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 252, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 3;
-			}
-			break;
-		case 0x88: /* EQUk */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2];
-				u->wst.dat[u->wst.ptr] = b == a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 254, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 1;
-			}
-			break;
-		case 0x89: /* NEQk */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2];
-				u->wst.dat[u->wst.ptr] = b != a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 254, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 1;
-			}
-			break;
-		case 0x8a: /* GTHk */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2];
-				u->wst.dat[u->wst.ptr] = b > a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 254, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 1;
-			}
-			break;
-		case 0x8b: /* LTHk */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2];
-				u->wst.dat[u->wst.ptr] = b < a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 254, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 1;
-			}
-			break;
-		case 0x8c: /* JMPk */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1];
-				u->ram.ptr += (Sint8)a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 1, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-			}
-			break;
-		case 0x8d: /* JCNk */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1];
-				if(u->wst.dat[u->wst.ptr - 2]) u->ram.ptr += (Sint8)a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-			}
-			break;
-		case 0x8e: /* JSRk */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1];
-				u->rst.dat[u->rst.ptr] = u->ram.ptr >> 8;
-				u->rst.dat[u->rst.ptr + 1] = u->ram.ptr & 0xff;
-				u->ram.ptr += (Sint8)a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 1, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 253, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 2;
-			}
-			break;
-		case 0x8f: /* STHk */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1];
-				u->rst.dat[u->rst.ptr] = a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 1, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 254, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 1;
-			}
-			break;
-		case 0x90: /* LDZk */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1];
-				u->wst.dat[u->wst.ptr] = peek8(u->ram.dat, a);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 1, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 254, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 1;
-			}
-			break;
-		case 0x91: /* STZk */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1];
-				Uint8 b = u->wst.dat[u->wst.ptr - 2];
-				poke8(u->ram.dat, a, b);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-			}
-			break;
-		case 0x92: /* LDRk */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1];
-				u->wst.dat[u->wst.ptr] = peek8(u->ram.dat, u->ram.ptr + (Sint8)a);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 1, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 254, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 1;
-			}
-			break;
-		case 0x93: /* STRk */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1];
-				Uint8 b = u->wst.dat[u->wst.ptr - 2];
-				poke8(u->ram.dat, u->ram.ptr + (Sint8)a, b);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-			}
-			break;
-		case 0x94: /* LDAk */
-			{
-				Uint16 a = (u->wst.dat[u->wst.ptr - 1] | (u->wst.dat[u->wst.ptr - 2] << 8));
-				u->wst.dat[u->wst.ptr] = peek8(u->ram.dat, a);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 254, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 1;
-			}
-			break;
-		case 0x95: /* STAk */
-			{
-				Uint16 a = (u->wst.dat[u->wst.ptr - 1] | (u->wst.dat[u->wst.ptr - 2] << 8));
-				Uint8 b = u->wst.dat[u->wst.ptr - 3];
-				poke8(u->ram.dat, a, b);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 3, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-			}
-			break;
-		case 0x96: /* DEIk */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1];
-				u->wst.dat[u->wst.ptr] = devr8(&u->dev[a >> 4], a);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 1, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 254, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 1;
-			}
-			break;
-		case 0x97: /* DEOk */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2];
-				if(!devw8(&u->dev[a >> 4], a, b))
-					return 1;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-			}
-			break;
-		case 0x98: /* ADDk */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2];
-				u->wst.dat[u->wst.ptr] = b + a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 254, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 1;
-			}
-			break;
-		case 0x99: /* SUBk */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2];
-				u->wst.dat[u->wst.ptr] = b - a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 254, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 1;
-			}
-			break;
-		case 0x9a: /* MULk */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2];
-				u->wst.dat[u->wst.ptr] = b * a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 254, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 1;
-			}
-			break;
-		case 0x9b: /* DIVk */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2];
-				if(a == 0) {
-					u->wst.error = 3;
-#ifndef NO_STACK_CHECKS
-					goto error;
-#endif
-					a = 1;
-				}
-				u->wst.dat[u->wst.ptr] = b / a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 254, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 1;
-			}
-			break;
-		case 0x9c: /* ANDk */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2];
-				u->wst.dat[u->wst.ptr] = b & a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 254, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 1;
-			}
-			break;
-		case 0x9d: /* ORAk */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2];
-				u->wst.dat[u->wst.ptr] = b | a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 254, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 1;
-			}
-			break;
-		case 0x9e: /* EORk */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2];
-				u->wst.dat[u->wst.ptr] = b ^ a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 254, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 1;
-			}
-			break;
-		case 0x9f: /* SFTk */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2];
-				u->wst.dat[u->wst.ptr] = b >> (a & 0x07) << ((a & 0x70) >> 4);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 254, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 1;
-			}
-			break;
-		case 0xa1: /* INC2k */
-			{
-				Uint16 a = (u->wst.dat[u->wst.ptr - 1] | (u->wst.dat[u->wst.ptr - 2] << 8));
-				u->wst.dat[u->wst.ptr] = (a + 1) >> 8;
-				u->wst.dat[u->wst.ptr + 1] = (a + 1) & 0xff;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 253, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 2;
-			}
-			break;
-		case 0xa2: /* POP2k */
-			{
-				(u->wst.dat[u->wst.ptr - 1] | (u->wst.dat[u->wst.ptr - 2] << 8));
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-			}
-			break;
-		case 0xa3: /* DUP2k */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2];
-				u->wst.dat[u->wst.ptr] = b;
-				u->wst.dat[u->wst.ptr + 1] = a;
-				u->wst.dat[u->wst.ptr + 2] = b;
-				u->wst.dat[u->wst.ptr + 3] = a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 251, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 4;
-			}
-			break;
-		case 0xa4: /* NIP2k */
-			{
-				Uint16 a = (u->wst.dat[u->wst.ptr - 1] | (u->wst.dat[u->wst.ptr - 2] << 8));
-				(u->wst.dat[u->wst.ptr - 3] | (u->wst.dat[u->wst.ptr - 4] << 8));
-				u->wst.dat[u->wst.ptr] = a >> 8;
-				u->wst.dat[u->wst.ptr + 1] = a & 0xff;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 4, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 253, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 2;
-			}
-			break;
-		case 0xa5: /* SWP2k */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2], c = u->wst.dat[u->wst.ptr - 3], d = u->wst.dat[u->wst.ptr - 4];
-				u->wst.dat[u->wst.ptr] = b;
-				u->wst.dat[u->wst.ptr + 1] = a;
-				u->wst.dat[u->wst.ptr + 2] = d;
-				u->wst.dat[u->wst.ptr + 3] = c;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 4, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 251, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 4;
-			}
-			break;
-		case 0xa6: /* OVR2k */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2], c = u->wst.dat[u->wst.ptr - 3], d = u->wst.dat[u->wst.ptr - 4];
-				u->wst.dat[u->wst.ptr] = d;
-				u->wst.dat[u->wst.ptr + 1] = c;
-				u->wst.dat[u->wst.ptr + 2] = b;
-				u->wst.dat[u->wst.ptr + 3] = a;
-				u->wst.dat[u->wst.ptr + 4] = d;
-				u->wst.dat[u->wst.ptr + 5] = c;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 4, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 249, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 6;
-			}
-			break;
-		case 0xa7: /* ROT2k */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2], c = u->wst.dat[u->wst.ptr - 3], d = u->wst.dat[u->wst.ptr - 4], e = u->wst.dat[u->wst.ptr - 5], f = u->wst.dat[u->wst.ptr - 6];
-				u->wst.dat[u->wst.ptr] = d;
-				u->wst.dat[u->wst.ptr + 1] = c;
-				u->wst.dat[u->wst.ptr + 2] = b;
-				u->wst.dat[u->wst.ptr + 3] = a;
-				u->wst.dat[u->wst.ptr + 4] = f;
-				u->wst.dat[u->wst.ptr + 5] = e;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 6, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 249, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 6;
-			}
-			break;
-		case 0xa8: /* EQU2k */
-			{
-				Uint16 a = (u->wst.dat[u->wst.ptr - 1] | (u->wst.dat[u->wst.ptr - 2] << 8)), b = (u->wst.dat[u->wst.ptr - 3] | (u->wst.dat[u->wst.ptr - 4] << 8));
-				u->wst.dat[u->wst.ptr] = b == a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 4, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 254, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 1;
-			}
-			break;
-		case 0xa9: /* NEQ2k */
-			{
-				Uint16 a = (u->wst.dat[u->wst.ptr - 1] | (u->wst.dat[u->wst.ptr - 2] << 8)), b = (u->wst.dat[u->wst.ptr - 3] | (u->wst.dat[u->wst.ptr - 4] << 8));
-				u->wst.dat[u->wst.ptr] = b != a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 4, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 254, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 1;
-			}
-			break;
-		case 0xaa: /* GTH2k */
-			{
-				Uint16 a = (u->wst.dat[u->wst.ptr - 1] | (u->wst.dat[u->wst.ptr - 2] << 8)), b = (u->wst.dat[u->wst.ptr - 3] | (u->wst.dat[u->wst.ptr - 4] << 8));
-				u->wst.dat[u->wst.ptr] = b > a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 4, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 254, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 1;
-			}
-			break;
-		case 0xab: /* LTH2k */
-			{
-				Uint16 a = (u->wst.dat[u->wst.ptr - 1] | (u->wst.dat[u->wst.ptr - 2] << 8)), b = (u->wst.dat[u->wst.ptr - 3] | (u->wst.dat[u->wst.ptr - 4] << 8));
-				u->wst.dat[u->wst.ptr] = b < a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 4, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 254, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 1;
-			}
-			break;
-		case 0xac: /* JMP2k */
-			{
-				u->ram.ptr = (u->wst.dat[u->wst.ptr - 1] | (u->wst.dat[u->wst.ptr - 2] << 8));
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-			}
-			break;
-		case 0xad: /* JCN2k */
-			{
-				Uint16 a = (u->wst.dat[u->wst.ptr - 1] | (u->wst.dat[u->wst.ptr - 2] << 8));
-				if(u->wst.dat[u->wst.ptr - 3]) u->ram.ptr = a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 3, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-			}
-			break;
-		case 0xae: /* JSR2k */
-			{
-				u->rst.dat[u->rst.ptr] = u->ram.ptr >> 8;
-				u->rst.dat[u->rst.ptr + 1] = u->ram.ptr & 0xff;
-				u->ram.ptr = (u->wst.dat[u->wst.ptr - 1] | (u->wst.dat[u->wst.ptr - 2] << 8));
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 253, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 2;
-			}
-			break;
-		case 0xaf: /* STH2k */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2];
-				u->rst.dat[u->rst.ptr] = b;
-				u->rst.dat[u->rst.ptr + 1] = a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 253, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 2;
-			}
-			break;
-		case 0xb0: /* LDZ2k */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1];
-				u->wst.dat[u->wst.ptr] = peek8(u->ram.dat, a);
-				u->wst.dat[u->wst.ptr + 1] = peek8(u->ram.dat, a + 1);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 1, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 253, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 2;
-			}
-			break;
-		case 0xb1: /* STZ2k */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1];
-				Uint16 b = (u->wst.dat[u->wst.ptr - 2] | (u->wst.dat[u->wst.ptr - 3] << 8));
-				poke16(u->ram.dat, a, b);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 3, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-			}
-			break;
-		case 0xb2: /* LDR2k */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1];
-				u->wst.dat[u->wst.ptr] = peek8(u->ram.dat, u->ram.ptr + (Sint8)a);
-				u->wst.dat[u->wst.ptr + 1] = peek8(u->ram.dat, u->ram.ptr + (Sint8)a + 1);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 1, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 253, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 2;
-			}
-			break;
-		case 0xb3: /* STR2k */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1];
-				Uint16 b = (u->wst.dat[u->wst.ptr - 2] | (u->wst.dat[u->wst.ptr - 3] << 8));
-				poke16(u->ram.dat, u->ram.ptr + (Sint8)a, b);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 3, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-			}
-			break;
-		case 0xb4: /* LDA2k */
-			{
-				Uint16 a = (u->wst.dat[u->wst.ptr - 1] | (u->wst.dat[u->wst.ptr - 2] << 8));
-				u->wst.dat[u->wst.ptr] = peek8(u->ram.dat, a);
-				u->wst.dat[u->wst.ptr + 1] = peek8(u->ram.dat, a + 1);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 2, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 253, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 2;
-			}
-			break;
-		case 0xb5: /* STA2k */
-			{
-				Uint16 a = (u->wst.dat[u->wst.ptr - 1] | (u->wst.dat[u->wst.ptr - 2] << 8));
-				Uint16 b = (u->wst.dat[u->wst.ptr - 3] | (u->wst.dat[u->wst.ptr - 4] << 8));
-				poke16(u->ram.dat, a, b);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 4, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-			}
-			break;
-		case 0xb6: /* DEI2k */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1];
-				u->wst.dat[u->wst.ptr] = devr8(&u->dev[a >> 4], a);
-				u->wst.dat[u->wst.ptr + 1] = devr8(&u->dev[a >> 4], a + 1);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 1, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 253, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 2;
-			}
-			break;
-		case 0xb7: /* DEO2k */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1];
-				Uint16 b = (u->wst.dat[u->wst.ptr - 2] | (u->wst.dat[u->wst.ptr - 3] << 8));
-				if(!devw16(&u->dev[a >> 4], a, b))
-					return 1;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 3, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-#endif
-			}
-			break;
-		case 0xb8: /* ADD2k */
-			{
-				Uint16 a = (u->wst.dat[u->wst.ptr - 1] | (u->wst.dat[u->wst.ptr - 2] << 8)), b = (u->wst.dat[u->wst.ptr - 3] | (u->wst.dat[u->wst.ptr - 4] << 8));
-				u->wst.dat[u->wst.ptr] = (b + a) >> 8;
-				u->wst.dat[u->wst.ptr + 1] = (b + a) & 0xff;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 4, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 253, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 2;
-			}
-			break;
-		case 0xb9: /* SUB2k */
-			{
-				Uint16 a = (u->wst.dat[u->wst.ptr - 1] | (u->wst.dat[u->wst.ptr - 2] << 8)), b = (u->wst.dat[u->wst.ptr - 3] | (u->wst.dat[u->wst.ptr - 4] << 8));
-				u->wst.dat[u->wst.ptr] = (b - a) >> 8;
-				u->wst.dat[u->wst.ptr + 1] = (b - a) & 0xff;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 4, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 253, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 2;
-			}
-			break;
-		case 0xba: /* MUL2k */
-			{
-				Uint16 a = (u->wst.dat[u->wst.ptr - 1] | (u->wst.dat[u->wst.ptr - 2] << 8)), b = (u->wst.dat[u->wst.ptr - 3] | (u->wst.dat[u->wst.ptr - 4] << 8));
-				u->wst.dat[u->wst.ptr] = (b * a) >> 8;
-				u->wst.dat[u->wst.ptr + 1] = (b * a) & 0xff;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 4, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 253, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 2;
-			}
-			break;
-		case 0xbb: /* DIV2k */
-			{
-				Uint16 a = (u->wst.dat[u->wst.ptr - 1] | (u->wst.dat[u->wst.ptr - 2] << 8)), b = (u->wst.dat[u->wst.ptr - 3] | (u->wst.dat[u->wst.ptr - 4] << 8));
-				if(a == 0) {
-					u->wst.error = 3;
-#ifndef NO_STACK_CHECKS
-					goto error;
-#endif
-					a = 1;
-				}
-				u->wst.dat[u->wst.ptr] = (b / a) >> 8;
-				u->wst.dat[u->wst.ptr + 1] = (b / a) & 0xff;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 4, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 253, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 2;
-			}
-			break;
-		case 0xbc: /* AND2k */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2], c = u->wst.dat[u->wst.ptr - 3], d = u->wst.dat[u->wst.ptr - 4];
-				u->wst.dat[u->wst.ptr] = d & b;
-				u->wst.dat[u->wst.ptr + 1] = c & a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 4, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 253, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 2;
-			}
-			break;
-		case 0xbd: /* ORA2k */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2], c = u->wst.dat[u->wst.ptr - 3], d = u->wst.dat[u->wst.ptr - 4];
-				u->wst.dat[u->wst.ptr] = d | b;
-				u->wst.dat[u->wst.ptr + 1] = c | a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 4, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 253, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 2;
-			}
-			break;
-		case 0xbe: /* EOR2k */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1], b = u->wst.dat[u->wst.ptr - 2], c = u->wst.dat[u->wst.ptr - 3], d = u->wst.dat[u->wst.ptr - 4];
-				u->wst.dat[u->wst.ptr] = d ^ b;
-				u->wst.dat[u->wst.ptr + 1] = c ^ a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 4, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 253, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 2;
-			}
-			break;
-		case 0xbf: /* SFT2k */
-			{
-				Uint8 a = u->wst.dat[u->wst.ptr - 1];
-				Uint16 b = (u->wst.dat[u->wst.ptr - 2] | (u->wst.dat[u->wst.ptr - 3] << 8));
-				u->wst.dat[u->wst.ptr] = (b >> (a & 0x0f) << ((a & 0xf0) >> 4)) >> 8;
-				u->wst.dat[u->wst.ptr + 1] = (b >> (a & 0x0f) << ((a & 0xf0) >> 4)) & 0xff;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->wst.ptr < 3, 0)) {
-					u->wst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 253, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 2;
-			}
-			break;
-		case 0xc1: /* INCkr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1];
-				u->rst.dat[u->rst.ptr] = a + 1;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 1, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 254, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 1;
-			}
-			break;
-		case 0xc2: /* POPkr */
-			{
-				u->rst.dat[u->rst.ptr - 1];
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 1, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-			}
-			break;
-		case 0xc3: /* DUPkr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1];
-				u->rst.dat[u->rst.ptr] = a;
-				u->rst.dat[u->rst.ptr + 1] = a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 1, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 253, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 2;
-			}
-			break;
-		case 0xc4: /* NIPkr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1];
-				u->rst.dat[u->rst.ptr - 2];
-				u->rst.dat[u->rst.ptr] = a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 254, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 1;
-			}
-			break;
-		case 0xc5: /* SWPkr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2];
-				u->rst.dat[u->rst.ptr] = a;
-				u->rst.dat[u->rst.ptr + 1] = b;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 253, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 2;
-			}
-			break;
-		case 0xc6: /* OVRkr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2];
-				u->rst.dat[u->rst.ptr] = b;
-				u->rst.dat[u->rst.ptr + 1] = a;
-				u->rst.dat[u->rst.ptr + 2] = b;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 252, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 3;
-			}
-			break;
-		case 0xc7: /* ROTkr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2], c = u->rst.dat[u->rst.ptr - 3];
-				u->rst.dat[u->rst.ptr] = b;
-				u->rst.dat[u->rst.ptr + 1] = a;
-				u->rst.dat[u->rst.ptr + 2] = c;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 3, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 252, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 3;
-			}
-			break;
-		case 0xc8: /* EQUkr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2];
-				u->rst.dat[u->rst.ptr] = b == a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 254, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 1;
-			}
-			break;
-		case 0xc9: /* NEQkr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2];
-				u->rst.dat[u->rst.ptr] = b != a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 254, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 1;
-			}
-			break;
-		case 0xca: /* GTHkr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2];
-				u->rst.dat[u->rst.ptr] = b > a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 254, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 1;
-			}
-			break;
-		case 0xcb: /* LTHkr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2];
-				u->rst.dat[u->rst.ptr] = b < a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 254, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 1;
-			}
-			break;
-		case 0xcc: /* JMPkr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1];
-				u->ram.ptr += (Sint8)a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 1, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-			}
-			break;
-		case 0xcd: /* JCNkr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1];
-				if(u->rst.dat[u->rst.ptr - 2]) u->ram.ptr += (Sint8)a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-			}
-			break;
-		case 0xce: /* JSRkr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1];
-				u->wst.dat[u->wst.ptr] = u->ram.ptr >> 8;
-				u->wst.dat[u->wst.ptr + 1] = u->ram.ptr & 0xff;
-				u->ram.ptr += (Sint8)a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 1, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 253, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 2;
-			}
-			break;
-		case 0xcf: /* STHkr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1];
-				u->wst.dat[u->wst.ptr] = a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 1, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 254, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 1;
-			}
-			break;
-		case 0xd0: /* LDZkr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1];
-				u->rst.dat[u->rst.ptr] = peek8(u->ram.dat, a);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 1, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 254, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 1;
-			}
-			break;
-		case 0xd1: /* STZkr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1];
-				Uint8 b = u->rst.dat[u->rst.ptr - 2];
-				poke8(u->ram.dat, a, b);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-			}
-			break;
-		case 0xd2: /* LDRkr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1];
-				u->rst.dat[u->rst.ptr] = peek8(u->ram.dat, u->ram.ptr + (Sint8)a);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 1, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 254, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 1;
-			}
-			break;
-		case 0xd3: /* STRkr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1];
-				Uint8 b = u->rst.dat[u->rst.ptr - 2];
-				poke8(u->ram.dat, u->ram.ptr + (Sint8)a, b);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-			}
-			break;
-		case 0xd4: /* LDAkr */
-			{
-				Uint16 a = (u->rst.dat[u->rst.ptr - 1] | (u->rst.dat[u->rst.ptr - 2] << 8));
-				u->rst.dat[u->rst.ptr] = peek8(u->ram.dat, a);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 254, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 1;
-			}
-			break;
-		case 0xd5: /* STAkr */
-			{
-				Uint16 a = (u->rst.dat[u->rst.ptr - 1] | (u->rst.dat[u->rst.ptr - 2] << 8));
-				Uint8 b = u->rst.dat[u->rst.ptr - 3];
-				poke8(u->ram.dat, a, b);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 3, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-			}
-			break;
-		case 0xd6: /* DEIkr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1];
-				u->rst.dat[u->rst.ptr] = devr8(&u->dev[a >> 4], a);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 1, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 254, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 1;
-			}
-			break;
-		case 0xd7: /* DEOkr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2];
-				if(!devw8(&u->dev[a >> 4], a, b))
-					return 1;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-			}
-			break;
-		case 0xd8: /* ADDkr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2];
-				u->rst.dat[u->rst.ptr] = b + a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 254, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 1;
-			}
-			break;
-		case 0xd9: /* SUBkr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2];
-				u->rst.dat[u->rst.ptr] = b - a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 254, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 1;
-			}
-			break;
-		case 0xda: /* MULkr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2];
-				u->rst.dat[u->rst.ptr] = b * a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 254, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 1;
-			}
-			break;
-		case 0xdb: /* DIVkr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2];
-				if(a == 0) {
-					u->rst.error = 3;
-#ifndef NO_STACK_CHECKS
-					goto error;
-#endif
-					a = 1;
-				}
-				u->rst.dat[u->rst.ptr] = b / a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 254, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 1;
-			}
-			break;
-		case 0xdc: /* ANDkr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2];
-				u->rst.dat[u->rst.ptr] = b & a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 254, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 1;
-			}
-			break;
-		case 0xdd: /* ORAkr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2];
-				u->rst.dat[u->rst.ptr] = b | a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 254, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 1;
-			}
-			break;
-		case 0xde: /* EORkr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2];
-				u->rst.dat[u->rst.ptr] = b ^ a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 254, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 1;
-			}
-			break;
-		case 0xdf: /* SFTkr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2];
-				u->rst.dat[u->rst.ptr] = b >> (a & 0x07) << ((a & 0x70) >> 4);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 254, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 1;
-			}
-			break;
-		case 0xe1: /* INC2kr */
-			{
-				Uint16 a = (u->rst.dat[u->rst.ptr - 1] | (u->rst.dat[u->rst.ptr - 2] << 8));
-				u->rst.dat[u->rst.ptr] = (a + 1) >> 8;
-				u->rst.dat[u->rst.ptr + 1] = (a + 1) & 0xff;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 253, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 2;
-			}
-			break;
-		case 0xe2: /* POP2kr */
-			{
-				(u->rst.dat[u->rst.ptr - 1] | (u->rst.dat[u->rst.ptr - 2] << 8));
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-			}
-			break;
-		case 0xe3: /* DUP2kr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2];
-				u->rst.dat[u->rst.ptr] = b;
-				u->rst.dat[u->rst.ptr + 1] = a;
-				u->rst.dat[u->rst.ptr + 2] = b;
-				u->rst.dat[u->rst.ptr + 3] = a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 251, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 4;
-			}
-			break;
-		case 0xe4: /* NIP2kr */
-			{
-				Uint16 a = (u->rst.dat[u->rst.ptr - 1] | (u->rst.dat[u->rst.ptr - 2] << 8));
-				(u->rst.dat[u->rst.ptr - 3] | (u->rst.dat[u->rst.ptr - 4] << 8));
-				u->rst.dat[u->rst.ptr] = a >> 8;
-				u->rst.dat[u->rst.ptr + 1] = a & 0xff;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 4, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 253, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 2;
-			}
-			break;
-		case 0xe5: /* SWP2kr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2], c = u->rst.dat[u->rst.ptr - 3], d = u->rst.dat[u->rst.ptr - 4];
-				u->rst.dat[u->rst.ptr] = b;
-				u->rst.dat[u->rst.ptr + 1] = a;
-				u->rst.dat[u->rst.ptr + 2] = d;
-				u->rst.dat[u->rst.ptr + 3] = c;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 4, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 251, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 4;
-			}
-			break;
-		case 0xe6: /* OVR2kr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2], c = u->rst.dat[u->rst.ptr - 3], d = u->rst.dat[u->rst.ptr - 4];
-				u->rst.dat[u->rst.ptr] = d;
-				u->rst.dat[u->rst.ptr + 1] = c;
-				u->rst.dat[u->rst.ptr + 2] = b;
-				u->rst.dat[u->rst.ptr + 3] = a;
-				u->rst.dat[u->rst.ptr + 4] = d;
-				u->rst.dat[u->rst.ptr + 5] = c;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 4, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 249, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 6;
-			}
-			break;
-		case 0xe7: /* ROT2kr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2], c = u->rst.dat[u->rst.ptr - 3], d = u->rst.dat[u->rst.ptr - 4], e = u->rst.dat[u->rst.ptr - 5], f = u->rst.dat[u->rst.ptr - 6];
-				u->rst.dat[u->rst.ptr] = d;
-				u->rst.dat[u->rst.ptr + 1] = c;
-				u->rst.dat[u->rst.ptr + 2] = b;
-				u->rst.dat[u->rst.ptr + 3] = a;
-				u->rst.dat[u->rst.ptr + 4] = f;
-				u->rst.dat[u->rst.ptr + 5] = e;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 6, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 249, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 6;
-			}
-			break;
-		case 0xe8: /* EQU2kr */
-			{
-				Uint16 a = (u->rst.dat[u->rst.ptr - 1] | (u->rst.dat[u->rst.ptr - 2] << 8)), b = (u->rst.dat[u->rst.ptr - 3] | (u->rst.dat[u->rst.ptr - 4] << 8));
-				u->rst.dat[u->rst.ptr] = b == a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 4, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 254, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 1;
-			}
-			break;
-		case 0xe9: /* NEQ2kr */
-			{
-				Uint16 a = (u->rst.dat[u->rst.ptr - 1] | (u->rst.dat[u->rst.ptr - 2] << 8)), b = (u->rst.dat[u->rst.ptr - 3] | (u->rst.dat[u->rst.ptr - 4] << 8));
-				u->rst.dat[u->rst.ptr] = b != a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 4, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 254, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 1;
-			}
-			break;
-		case 0xea: /* GTH2kr */
-			{
-				Uint16 a = (u->rst.dat[u->rst.ptr - 1] | (u->rst.dat[u->rst.ptr - 2] << 8)), b = (u->rst.dat[u->rst.ptr - 3] | (u->rst.dat[u->rst.ptr - 4] << 8));
-				u->rst.dat[u->rst.ptr] = b > a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 4, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 254, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 1;
-			}
-			break;
-		case 0xeb: /* LTH2kr */
-			{
-				Uint16 a = (u->rst.dat[u->rst.ptr - 1] | (u->rst.dat[u->rst.ptr - 2] << 8)), b = (u->rst.dat[u->rst.ptr - 3] | (u->rst.dat[u->rst.ptr - 4] << 8));
-				u->rst.dat[u->rst.ptr] = b < a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 4, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 254, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 1;
-			}
-			break;
-		case 0xec: /* JMP2kr */
-			{
-				u->ram.ptr = (u->rst.dat[u->rst.ptr - 1] | (u->rst.dat[u->rst.ptr - 2] << 8));
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-			}
-			break;
-		case 0xed: /* JCN2kr */
-			{
-				Uint16 a = (u->rst.dat[u->rst.ptr - 1] | (u->rst.dat[u->rst.ptr - 2] << 8));
-				if(u->rst.dat[u->rst.ptr - 3]) u->ram.ptr = a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 3, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-			}
-			break;
-		case 0xee: /* JSR2kr */
-			{
-				u->wst.dat[u->wst.ptr] = u->ram.ptr >> 8;
-				u->wst.dat[u->wst.ptr + 1] = u->ram.ptr & 0xff;
-				u->ram.ptr = (u->rst.dat[u->rst.ptr - 1] | (u->rst.dat[u->rst.ptr - 2] << 8));
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 253, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 2;
-			}
-			break;
-		case 0xef: /* STH2kr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2];
-				u->wst.dat[u->wst.ptr] = b;
-				u->wst.dat[u->wst.ptr + 1] = a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->wst.ptr > 253, 0)) {
-					u->wst.error = 2;
-					goto error;
-				}
-#endif
-				u->wst.ptr += 2;
-			}
-			break;
-		case 0xf0: /* LDZ2kr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1];
-				u->rst.dat[u->rst.ptr] = peek8(u->ram.dat, a);
-				u->rst.dat[u->rst.ptr + 1] = peek8(u->ram.dat, a + 1);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 1, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 253, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 2;
-			}
-			break;
-		case 0xf1: /* STZ2kr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1];
-				Uint16 b = (u->rst.dat[u->rst.ptr - 2] | (u->rst.dat[u->rst.ptr - 3] << 8));
-				poke16(u->ram.dat, a, b);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 3, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-			}
-			break;
-		case 0xf2: /* LDR2kr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1];
-				u->rst.dat[u->rst.ptr] = peek8(u->ram.dat, u->ram.ptr + (Sint8)a);
-				u->rst.dat[u->rst.ptr + 1] = peek8(u->ram.dat, u->ram.ptr + (Sint8)a + 1);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 1, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 253, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 2;
-			}
-			break;
-		case 0xf3: /* STR2kr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1];
-				Uint16 b = (u->rst.dat[u->rst.ptr - 2] | (u->rst.dat[u->rst.ptr - 3] << 8));
-				poke16(u->ram.dat, u->ram.ptr + (Sint8)a, b);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 3, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-#endif
-			}
-			break;
-		case 0xf4: /* LDA2kr */
-			{
-				Uint16 a = (u->rst.dat[u->rst.ptr - 1] | (u->rst.dat[u->rst.ptr - 2] << 8));
-				u->rst.dat[u->rst.ptr] = peek8(u->ram.dat, a);
-				u->rst.dat[u->rst.ptr + 1] = peek8(u->ram.dat, a + 1);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 2, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 253, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
-#endif
-				u->rst.ptr += 2;
-			}
-			break;
-		case 0xf5: /* STA2kr */
-			{
-				Uint16 a = (u->rst.dat[u->rst.ptr - 1] | (u->rst.dat[u->rst.ptr - 2] << 8));
-				Uint16 b = (u->rst.dat[u->rst.ptr - 3] | (u->rst.dat[u->rst.ptr - 4] << 8));
-				poke16(u->ram.dat, a, b);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 4, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
+The opcode handlers are not written by hand: etc/mkuxn.py generates them from
+the opcode table in etc/opcodes.txt into uxncore.h in the build directory, with
+stack checks for CPU_ERROR_CHECKING builds and without for the others. This
+file holds the interpreter loop they are included into, the predecoder for
+the superinstructions listed in the same table and, for CPU_ERROR_CHECKING
+builds, the basic block cache that lets them test the stacks once per block.
+*/
+
+#define MODE_RETURN 0x40
+#define MODE_KEEP 0x80
+
+#pragma mark - Operations
+
+/* fuse[] holds, for each address of the program, the number of the
+   superinstruction starting there, or FUSE_COVERED for the other opcode bytes
+   of one. A store to a marked byte turns every superinstruction that might
+   span it back into plain opcodes; the marks themselves stay, so that a later
+   store there is caught as well. */
+#define FUSE_COVERED 0xff
+
+static void
+unfuse(Uint8 *fuse, Uint16 a)
+{
+	int i;
+	for(i = 0; i < FUSE_SPAN; i++)
+		if(fuse[(Uint16)(a - i)])
+			fuse[(Uint16)(a - i)] = FUSE_COVERED;
+}
+
+#ifdef BLOCK_CACHE
+#define BLOCK_CODE(c, a) ((c)[(a) >> 3] & (1 << ((a) & 7)))
+static void flushblocks(Uxn *u);
 #endif
-			}
-			break;
-		case 0xf6: /* DEI2kr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1];
-				u->rst.dat[u->rst.ptr] = devr8(&u->dev[a >> 4], a);
-				u->rst.dat[u->rst.ptr + 1] = devr8(&u->dev[a >> 4], a + 1);
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 1, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 253, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
+
+#ifdef UXN_AOT
+/* Builds with UXN_AOT run the vectors of one ROM from C translated ahead of
+   time by etc/uxn2c.py, for as long as memory holds that ROM: aot_dirty is set
+   for good when a store or load reaches one of the opcode bytes it was
+   translated from, or when another ROM is loaded. */
+#define AOT_CODE(a) (aot_code[(a) >> 3] & (1 << ((a) & 7)))
+static const Uint8 aot_code[65536 / 8];
+static Uint8 aot_dirty;
 #endif
-				u->rst.ptr += 2;
-			}
-			break;
-		case 0xf7: /* DEO2kr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1];
-				Uint16 b = (u->rst.dat[u->rst.ptr - 2] | (u->rst.dat[u->rst.ptr - 3] << 8));
-				if(!devw16(&u->dev[a >> 4], a, b))
-					return 1;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 3, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
+
+/* clang-format off */
+#ifdef BLOCK_CACHE
+/* A store into an opcode byte that a cached block was decoded from drops the
+   whole block cache. The handlers call these with the locals of runuxn. */
+static inline void   storeblock8(Uxn *u, Uint8 *m, Uint8 *f, Uint16 a, Uint8 b) { m[a] = b; if(f[a]) unfuse(f, a); if(BLOCK_CODE(u->ram.code, a)) flushblocks(u); }
+static inline void   storeblock16(Uxn *u, Uint8 *m, Uint8 *f, Uint16 a, Uint16 b) { storeblock8(u, m, f, a, b >> 8); storeblock8(u, m, f, a + 1, b); }
+#define store8(m, f, a, b) storeblock8(u, m, f, a, b)
+#define store16(m, f, a, b) storeblock16(u, m, f, a, b)
+#elif defined(UXN_AOT)
+static inline void   storeaot8(Uint8 *m, Uint8 *f, Uint16 a, Uint8 b) { m[a] = b; if(f[a]) unfuse(f, a); if(AOT_CODE(a)) aot_dirty = 1; }
+static inline void   storeaot16(Uint8 *m, Uint8 *f, Uint16 a, Uint16 b) { storeaot8(m, f, a, b >> 8); storeaot8(m, f, a + 1, b); }
+#define store8 storeaot8
+#define store16 storeaot16
+#else
+static inline void   store8(Uint8 *m, Uint8 *f, Uint16 a, Uint8 b) { m[a] = b; if(f[a]) unfuse(f, a); }
+static inline void   store16(Uint8 *m, Uint8 *f, Uint16 a, Uint16 b) { store8(m, f, a, b >> 8); store8(m, f, a + 1, b); }
+#endif
+#ifdef BIND_DEVICES
+/* The screen and audio handlers of the device map set up by emulator.c are
+   called directly; only the other devices go through d->talk. */
+int screen_talk(Device *d, Uint8 b0, Uint8 w);
+int screen_talk16(Device *d, Uint8 b0, Uint8 w);
+int audio_talk(Device *d, Uint8 b0, Uint8 w);
+#define TALK(d, b0, w) ((d)->addr == 0x20 ? screen_talk(d, b0, w) : (Uint8)((d)->addr - 0x30) < 0x40 ? audio_talk(d, b0, w) : (d)->talk(d, b0, w))
+#define TALK16(d, b0, w) ((d)->addr == 0x20 ? screen_talk16(d, b0, w) : (d)->talk16(d, b0, w))
+#else
+#define TALK(d, b0, w) (d)->talk(d, b0, w)
+#define TALK16(d, b0, w) (d)->talk16(d, b0, w)
+#endif
+static inline int    devw8(Device *d, Uint8 a, Uint8 b) { d->dat[a & 0xf] = b; return !(d->whook >> (a & 0xf) & 1) || TALK(d, a & 0x0f, 1); }
+static inline Uint8  devr8(Device *d, Uint8 a) { if(d->rhook >> (a & 0xf) & 1) TALK(d, a & 0x0f, 0); return d->dat[a & 0xf];  }
+/* A short access goes to talk16 once, with both bytes in place, when either
+   of its ports is hooked; without a talk16 each byte is accessed in turn. */
+static inline int    devhook16(Uint16 hook, Uint8 a) { return ((u32)hook | (u32)hook << 16) >> (a & 0xf) & 3; }
+static inline int    devw16(Device *d, Uint8 a, Uint16 b) {
+	if(!d->talk16 || !devhook16(d->whook, a)) return devw8(d, a, b >> 8) && devw8(d, a + 1, b);
+	d->dat[a & 0xf] = b >> 8; d->dat[(a + 1) & 0xf] = b; return TALK16(d, a & 0xf, 1); }
+static inline Uint16 devr16(Device *d, Uint8 a) {
+	Uint8 hi;
+	if(d->talk16 && devhook16(d->rhook, a)) { TALK16(d, a & 0xf, 0); return d->dat[a & 0xf] << 8 | d->dat[(a + 1) & 0xf]; }
+	hi = devr8(d, a); return hi << 8 | devr8(d, a + 1); }
+
+/* clang-format on */
+
+#pragma mark - Blocks
+
+#ifdef BLOCK_CACHE
+/* Straight-line code runs a basic block at a time: the stack pointers are
+   tested against the bounds of the whole block on entry, and its instructions
+   then run from a core without per-instruction checks until the jump, device
+   access or BRK that ends it. Blocks are kept in a direct-mapped table keyed
+   by entry address. The opcode bytes they were decoded from are marked in
+   ram.code; literal data is read when it runs, as everywhere else, so that
+   stores into LIT operands - the usual way of keeping variables in uxntal -
+   leave the cache alone. The zero page is never cached, STZ does not track
+   its stores. */
+#define BLOCK_COUNT 4096
+#define BLOCK_SLOT(a) ((a) & (BLOCK_COUNT - 1))
+
+static void
+flushblocks(Uxn *u)
+{
+	memset(u->ram.blocks, 0, sizeof(Block) * BLOCK_COUNT);
+	memset(u->ram.code, 0, 65536 / 8);
+}
+
+static Block *
+buildblock(Uxn *u, Uint16 addr)
+{
+	Block *b = &u->ram.blocks[BLOCK_SLOT(addr)];
+	Uint8 *ram = u->ram.dat, *code = u->ram.code;
+	int a = addr, w = 0, r = 0, wlo = 0, whi = 0, rlo = 0, rhi = 0, ends = 0;
+	while(!ends && a < 0x10000) {
+		Uint8 op = ram[a];
+		if(effects[op].wneed - w > wlo) wlo = effects[op].wneed - w;
+		if(effects[op].rneed - r > rlo) rlo = effects[op].rneed - r;
+		w += effects[op].wdelta;
+		r += effects[op].rdelta;
+		if(w > whi) whi = w;
+		if(r > rhi) rhi = r;
+		ends = effects[op].ends;
+		code[a >> 3] |= 1 << (a & 7);
+		a += effects[op].length;
+	}
+	/* Blocks running off the end of memory or needing more than a stack
+	   can hold are not cached; their code is stepped through instead. */
+	if(!ends || wlo + whi > 255 || rlo + rhi > 255)
+		return NULL;
+	b->addr = addr;
+	b->wlo = wlo;
+	b->wspan = 255 - whi - wlo;
+	b->rlo = rlo;
+	b->rspan = 255 - rhi - rlo;
+	return b;
+}
 #endif
-			}
-			break;
-		case 0xf8: /* ADD2kr */
-			{
-				Uint16 a = (u->rst.dat[u->rst.ptr - 1] | (u->rst.dat[u->rst.ptr - 2] << 8)), b = (u->rst.dat[u->rst.ptr - 3] | (u->rst.dat[u->rst.ptr - 4] << 8));
-				u->rst.dat[u->rst.ptr] = (b + a) >> 8;
-				u->rst.dat[u->rst.ptr + 1] = (b + a) & 0xff;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 4, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 253, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
+
+#pragma mark - Core
+
+/* The profile build also leaves where it is in uxn_at and uxn_vector, for
+   the sampling profiler's timer interrupt to pick up. */
+#ifdef DEBUG_PROFILE
+u32 uxn_opcode_counts[256], uxn_addr_counts[65536];
+DTCM_BSS volatile u32 uxn_at;
+DTCM_BSS volatile Uint16 uxn_vector;
+#define PROFILE_OPCODE(op, addr) \
+	(uxn_opcode_counts[op]++, uxn_addr_counts[(Uint16)(addr)]++, \
+		uxn_at = (Uint16)(addr) | rptr << 16)
+#define PROFILE_VECTOR(vec) (uxn_vector = (vec))
+#else
+#define PROFILE_OPCODE(op, addr) ((void)0)
+#define PROFILE_VECTOR(vec) ((void)0)
 #endif
-				u->rst.ptr += 2;
-			}
-			break;
-		case 0xf9: /* SUB2kr */
-			{
-				Uint16 a = (u->rst.dat[u->rst.ptr - 1] | (u->rst.dat[u->rst.ptr - 2] << 8)), b = (u->rst.dat[u->rst.ptr - 3] | (u->rst.dat[u->rst.ptr - 4] << 8));
-				u->rst.dat[u->rst.ptr] = (b - a) >> 8;
-				u->rst.dat[u->rst.ptr + 1] = (b - a) & 0xff;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 4, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 253, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
+
+/* COUNT_OPCODE counts the instruction op at addr; COUNT_INSTRUCTION the one
+   runuxn just fetched. Superinstructions count the instructions they run
+   after the first with COUNT_FUSED, and profile each with PROFILE_OPCODE. */
+#ifdef UXN_COUNTERS
+DTCM_BSS unsigned long long uxn_instructions, uxn_fused;
+u32 uxn_suspends;
+#define COUNT_OPCODE(op, addr) (uxn_instructions++, PROFILE_OPCODE(op, addr))
+#define COUNT_FUSED(n) (uxn_instructions += (n), uxn_fused += (n))
+#else
+#define COUNT_OPCODE(op, addr) ((void)0)
+#define COUNT_FUSED(n)
+#endif
+#define COUNT_INSTRUCTION COUNT_OPCODE(instr, pc - 1)
+
+/* With THREADED_DISPATCH, the switch only dispatches the first instruction of a
+   vector; after that every handler fetches and jumps to the next one through a
+   label table instead of returning to the shared switch. Handlers end with
+   continue rather than break, so that superinstructions can be dispatched from
+   a nested switch. */
+#ifdef THREADED_DISPATCH
+#define OPCODE(n) case n: op_##n
+#define NEXT \
+	do { \
+		instr = ram[pc++]; \
+		COUNT_INSTRUCTION; \
+		goto *dispatch[instr]; \
+	} while(0)
+#else
+#define OPCODE(n) case n
+#define NEXT continue
 #endif
-				u->rst.ptr += 2;
-			}
-			break;
-		case 0xfa: /* MUL2kr */
-			{
-				Uint16 a = (u->rst.dat[u->rst.ptr - 1] | (u->rst.dat[u->rst.ptr - 2] << 8)), b = (u->rst.dat[u->rst.ptr - 3] | (u->rst.dat[u->rst.ptr - 4] << 8));
-				u->rst.dat[u->rst.ptr] = (b * a) >> 8;
-				u->rst.dat[u->rst.ptr + 1] = (b * a) & 0xff;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 4, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 253, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
+
+/* Every jump takes one from the budget of the vector, which is suspended where
+   it runs out; budget starting at 0 runs out only after 2^32 jumps. */
+#define CHECK_BUDGET \
+	if(!--budget) \
+		goto suspend
+
+/* The handlers of the block core leave the block through these: after a
+   jump, device access or BRK, and after a store that dropped the cache, as the
+   rest of the block may be the code that changed. */
+#define NEXT_BLOCK goto next_block
+#define NEXT_STORE \
+	if(!b->addr) \
+		goto next_block; \
+	else \
+		NEXT
+
+/* The program counter, both stack pointers and the top byte of the working
+   stack are kept in locals for the whole of runuxn. SYNC writes them back to
+   the Uxn struct before anything outside the interpreter can look at it: at
+   BRK, on errors and before every device access. */
+#define SYNC() \
+	do { \
+		u->ram.ptr = pc; \
+		u->wst.ptr = wptr; \
+		u->rst.ptr = rptr; \
+		if(wptr) u->wst.dat[wptr - 1] = wtop; \
+	} while(0)
+
+#ifdef UXN_AOT
+/* The translated functions keep the stacks in memory between basic blocks,
+   with no top of stack in a register. */
+#define AOT_SYNC() \
+	do { \
+		u->ram.ptr = pc; \
+		u->wst.ptr = wptr; \
+		u->rst.ptr = rptr; \
+	} while(0)
+
+#include "uxnaot.h"
 #endif
-				u->rst.ptr += 2;
+
+/* Runs vec from pc, which is vec itself unless the vector is being resumed. */
+static int
+enteruxn(Uxn *u, Uint16 vec, Uint16 pc)
+{
+	int ret = -1;
+	PROFILE_VECTOR(vec);
+#ifdef UXN_AOT
+	if(!aot_dirty) {
+		int i;
+		for(i = 0; i < (int)(sizeof(aot_vectors) / sizeof(*aot_vectors)); i++)
+			if(aot_vectors[i].vector == vec) {
+				/* The translation gives up where it meets a jump it
+				   could not follow, and leaves the rest to runuxn. */
+				ret = aot_vectors[i].run(u, &pc);
+				break;
 			}
-			break;
-		case 0xfb: /* DIV2kr */
-			{
-				Uint16 a = (u->rst.dat[u->rst.ptr - 1] | (u->rst.dat[u->rst.ptr - 2] << 8)), b = (u->rst.dat[u->rst.ptr - 3] | (u->rst.dat[u->rst.ptr - 4] << 8));
-				if(a == 0) {
-					u->rst.error = 3;
-#ifndef NO_STACK_CHECKS
-					goto error;
-#endif
-					a = 1;
-				}
-				u->rst.dat[u->rst.ptr] = (b / a) >> 8;
-				u->rst.dat[u->rst.ptr + 1] = (b / a) & 0xff;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 4, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 253, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
+	}
 #endif
-				u->rst.ptr += 2;
-			}
-			break;
-		case 0xfc: /* AND2kr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2], c = u->rst.dat[u->rst.ptr - 3], d = u->rst.dat[u->rst.ptr - 4];
-				u->rst.dat[u->rst.ptr] = d & b;
-				u->rst.dat[u->rst.ptr + 1] = c & a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 4, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 253, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
+	if(ret < 0)
+		ret = runuxn(u, pc);
+	if(ret == UXN_SUSPENDED) {
+		u->suspended = vec;
+#ifdef UXN_COUNTERS
+		uxn_suspends++;
 #endif
-				u->rst.ptr += 2;
-			}
-			break;
-		case 0xfd: /* ORA2kr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2], c = u->rst.dat[u->rst.ptr - 3], d = u->rst.dat[u->rst.ptr - 4];
-				u->rst.dat[u->rst.ptr] = d | b;
-				u->rst.dat[u->rst.ptr + 1] = c | a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 4, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 253, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
+	}
+	PROFILE_VECTOR(0);
+	return ret;
+}
+
+/* evaluxn runs a vector up to its BRK, or until it has taken u->budget
+   jumps; resumeuxn goes on with a suspended vector for as many again.
+   runuxn goes on from any address in the middle of a vector, without the
+   checks made on entering it. */
+int
+evaluxn(Uxn *u, Uint16 vec)
+{
+	if(!vec || u->dev[0].dat[0xf]) 
+		return 0;
+	if(u->suspended)
+		return UXN_SUSPENDED;
+	if(u->wst.ptr > 0xf8) u->wst.ptr = 0xf8;
+	return enteruxn(u, vec, vec);
+}
+
+int
+resumeuxn(Uxn *u)
+{
+	Uint16 vec = u->suspended;
+	if(!vec || u->dev[0].dat[0xf])
+		return 0;
+	u->suspended = 0;
+	return enteruxn(u, vec, u->ram.ptr);
+}
+
+ITCM_ARM_CODE
+int
+runuxn(Uxn *u, Uint16 pc)
+{
+	Uint8 instr, wptr, rptr, wtop;
+	Uint8 *ram, *fuse;
+	u32 budget = u->budget;
+	ram = u->ram.dat;
+	fuse = u->ram.fuse;
+	wptr = u->wst.ptr;
+	rptr = u->rst.ptr;
+	wtop = wptr ? u->wst.dat[wptr - 1] : 0;
+#ifdef THREADED_DISPATCH
+	static const void *dispatch[256] = {
+		&&brk, &&op_0x01, &&op_0x02, &&op_0x03, &&op_0x04, &&op_0x05, &&op_0x06, &&op_0x07,
+		&&op_0x08, &&op_0x09, &&op_0x0a, &&op_0x0b, &&op_0x0c, &&op_0x0d, &&op_0x0e, &&op_0x0f,
+		&&op_0x10, &&op_0x11, &&op_0x12, &&op_0x13, &&op_0x14, &&op_0x15, &&op_0x16, &&op_0x17,
+		&&op_0x18, &&op_0x19, &&op_0x1a, &&op_0x1b, &&op_0x1c, &&op_0x1d, &&op_0x1e, &&op_0x1f,
+		&&op_0x20, &&op_0x21, &&op_0x22, &&op_0x23, &&op_0x24, &&op_0x25, &&op_0x26, &&op_0x27,
+		&&op_0x28, &&op_0x29, &&op_0x2a, &&op_0x2b, &&op_0x2c, &&op_0x2d, &&op_0x2e, &&op_0x2f,
+		&&op_0x30, &&op_0x31, &&op_0x32, &&op_0x33, &&op_0x34, &&op_0x35, &&op_0x36, &&op_0x37,
+		&&op_0x38, &&op_0x39, &&op_0x3a, &&op_0x3b, &&op_0x3c, &&op_0x3d, &&op_0x3e, &&op_0x3f,
+		&&op_0x40, &&op_0x41, &&op_0x42, &&op_0x43, &&op_0x44, &&op_0x45, &&op_0x46, &&op_0x47,
+		&&op_0x48, &&op_0x49, &&op_0x4a, &&op_0x4b, &&op_0x4c, &&op_0x4d, &&op_0x4e, &&op_0x4f,
+		&&op_0x50, &&op_0x51, &&op_0x52, &&op_0x53, &&op_0x54, &&op_0x55, &&op_0x56, &&op_0x57,
+		&&op_0x58, &&op_0x59, &&op_0x5a, &&op_0x5b, &&op_0x5c, &&op_0x5d, &&op_0x5e, &&op_0x5f,
+		&&op_0x60, &&op_0x61, &&op_0x62, &&op_0x63, &&op_0x64, &&op_0x65, &&op_0x66, &&op_0x67,
+		&&op_0x68, &&op_0x69, &&op_0x6a, &&op_0x6b, &&op_0x6c, &&op_0x6d, &&op_0x6e, &&op_0x6f,
+		&&op_0x70, &&op_0x71, &&op_0x72, &&op_0x73, &&op_0x74, &&op_0x75, &&op_0x76, &&op_0x77,
+		&&op_0x78, &&op_0x79, &&op_0x7a, &&op_0x7b, &&op_0x7c, &&op_0x7d, &&op_0x7e, &&op_0x7f,
+		&&op_0x80, &&op_0x81, &&op_0x82, &&op_0x83, &&op_0x84, &&op_0x85, &&op_0x86, &&op_0x87,
+		&&op_0x88, &&op_0x89, &&op_0x8a, &&op_0x8b, &&op_0x8c, &&op_0x8d, &&op_0x8e, &&op_0x8f,
+		&&op_0x90, &&op_0x91, &&op_0x92, &&op_0x93, &&op_0x94, &&op_0x95, &&op_0x96, &&op_0x97,
+		&&op_0x98, &&op_0x99, &&op_0x9a, &&op_0x9b, &&op_0x9c, &&op_0x9d, &&op_0x9e, &&op_0x9f,
+		&&op_0xa0, &&op_0xa1, &&op_0xa2, &&op_0xa3, &&op_0xa4, &&op_0xa5, &&op_0xa6, &&op_0xa7,
+		&&op_0xa8, &&op_0xa9, &&op_0xaa, &&op_0xab, &&op_0xac, &&op_0xad, &&op_0xae, &&op_0xaf,
+		&&op_0xb0, &&op_0xb1, &&op_0xb2, &&op_0xb3, &&op_0xb4, &&op_0xb5, &&op_0xb6, &&op_0xb7,
+		&&op_0xb8, &&op_0xb9, &&op_0xba, &&op_0xbb, &&op_0xbc, &&op_0xbd, &&op_0xbe, &&op_0xbf,
+		&&op_0xc0, &&op_0xc1, &&op_0xc2, &&op_0xc3, &&op_0xc4, &&op_0xc5, &&op_0xc6, &&op_0xc7,
+		&&op_0xc8, &&op_0xc9, &&op_0xca, &&op_0xcb, &&op_0xcc, &&op_0xcd, &&op_0xce, &&op_0xcf,
+		&&op_0xd0, &&op_0xd1, &&op_0xd2, &&op_0xd3, &&op_0xd4, &&op_0xd5, &&op_0xd6, &&op_0xd7,
+		&&op_0xd8, &&op_0xd9, &&op_0xda, &&op_0xdb, &&op_0xdc, &&op_0xdd, &&op_0xde, &&op_0xdf,
+		&&op_0xe0, &&op_0xe1, &&op_0xe2, &&op_0xe3, &&op_0xe4, &&op_0xe5, &&op_0xe6, &&op_0xe7,
+		&&op_0xe8, &&op_0xe9, &&op_0xea, &&op_0xeb, &&op_0xec, &&op_0xed, &&op_0xee, &&op_0xef,
+		&&op_0xf0, &&op_0xf1, &&op_0xf2, &&op_0xf3, &&op_0xf4, &&op_0xf5, &&op_0xf6, &&op_0xf7,
+		&&op_0xf8, &&op_0xf9, &&op_0xfa, &&op_0xfb, &&op_0xfc, &&op_0xfd, &&op_0xfe, &&op_0xff,
+	};
 #endif
-				u->rst.ptr += 2;
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-value"
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#pragma GCC diagnostic ignored "-Wunused-label"
+#ifdef BLOCK_CACHE
+	for(;;) {
+		Block *b = &u->ram.blocks[BLOCK_SLOT(pc)];
+		if(pc >= PAGE_PROGRAM) {
+			if(b->addr != pc)
+				b = buildblock(u, pc);
+			if(b && (Uint8)(wptr - b->wlo) <= b->wspan && (Uint8)(rptr - b->rlo) <= b->rspan) {
+				for(;;) {
+					instr = ram[pc++];
+					COUNT_INSTRUCTION;
+					switch(instr) {
+					case 0x00: goto brk;
+#include "uxnblock.h"
+					}
+				}
+			next_block:
+				continue;
 			}
-			break;
-		case 0xfe: /* EOR2kr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1], b = u->rst.dat[u->rst.ptr - 2], c = u->rst.dat[u->rst.ptr - 3], d = u->rst.dat[u->rst.ptr - 4];
-				u->rst.dat[u->rst.ptr] = d ^ b;
-				u->rst.dat[u->rst.ptr + 1] = c ^ a;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 4, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 253, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
+		}
+		/* Too close to an end of a stack to run the block unchecked: step
+		   through it with checks, so that a halt happens at the instruction
+		   that caused it. */
+		instr = ram[pc++];
+		COUNT_INSTRUCTION;
+		if(!instr)
+			goto brk;
+		switch(instr) {
+#undef OPCODE
+#undef NEXT
+#define OPCODE(n) case n
+#define NEXT continue
+#include "uxncore.h"
+		}
+	}
+#else
+	while((instr = ram[pc++])) {
+		COUNT_INSTRUCTION;
+		switch(instr) {
+#include "uxncore.h"
+		}
+	}
+#ifndef THREADED_DISPATCH
+	COUNT_INSTRUCTION; /* BRK */
 #endif
-				u->rst.ptr += 2;
-			}
-			break;
-		case 0xff: /* SFT2kr */
-			{
-				Uint8 a = u->rst.dat[u->rst.ptr - 1];
-				Uint16 b = (u->rst.dat[u->rst.ptr - 2] | (u->rst.dat[u->rst.ptr - 3] << 8));
-				u->rst.dat[u->rst.ptr] = (b >> (a & 0x0f) << ((a & 0xf0) >> 4)) >> 8;
-				u->rst.dat[u->rst.ptr + 1] = (b >> (a & 0x0f) << ((a & 0xf0) >> 4)) & 0xff;
-#ifndef NO_STACK_CHECKS
-				if(__builtin_expect(u->rst.ptr < 3, 0)) {
-					u->rst.error = 1;
-					goto error;
-				}
-				if(__builtin_expect(u->rst.ptr > 253, 0)) {
-					u->rst.error = 2;
-					goto error;
-				}
 #endif
-				u->rst.ptr += 2;
-			}
-			break;
 #pragma GCC diagnostic pop
-		}
-	}
+#if defined(THREADED_DISPATCH) || defined(BLOCK_CACHE)
+brk:
+#endif
+	SYNC();
 	return 1;
+suspend:
+	SYNC();
+	return UXN_SUSPENDED;
 #ifndef NO_STACK_CHECKS
 error:
+	SYNC();
 	dprintf("Halted: %s-stack %sflow#%04x, at 0x%04x\n",
 		u->wst.error ? "Working" : "Return",
 		((u->wst.error | u->rst.error) & 2) ? "over" : "under",
@@ -4038,9 +433,84 @@ int
 bootuxn(Uxn *u)
 {
         memset(u, 0, sizeof(*u));
-        u->ram.dat = malloc(65536);
-        memset(u->ram.dat, 0, 65536);
+        u->ram.dat = calloc(UXN_BANKS, 65536);
+        u->ram.fuse = calloc(65536, 1);
+        if(!u->ram.dat || !u->ram.fuse)
+                goto fail;
+#ifdef BLOCK_CACHE
+        u->ram.code = calloc(65536 / 8, 1);
+        u->ram.blocks = calloc(BLOCK_COUNT, sizeof(Block));
+        if(!u->ram.code || !u->ram.blocks)
+                goto fail;
+#endif
         return 1;
+fail:
+        free(u->ram.dat);
+        free(u->ram.fuse);
+#ifdef BLOCK_CACHE
+        free(u->ram.code);
+        free(u->ram.blocks);
+#endif
+        memset(u, 0, sizeof(*u));
+        return 0;
+}
+
+#ifdef UXNDS_HOST
+void (*uxn_load_hook)(Uxn *u, Uint16 addr, Uint16 length);
+#endif
+
+void
+fuseuxn(Uxn *u, Uint16 addr, Uint16 length)
+{
+	Uint8 *ram = u->ram.dat, *fuse = u->ram.fuse, first[256] = {0};
+	int a, i, j, end = addr + length;
+	if(end > 0x10000)
+		end = 0x10000;
+	for(i = 0; i < FUSE_COUNT; i++)
+		first[fusions[i].code[0]] = 1;
+#ifdef UXNDS_HOST
+	if(uxn_load_hook)
+		uxn_load_hook(u, addr, end - addr);
+#endif
+	for(a = addr; a < end; a++)
+		if(fuse[a])
+			unfuse(fuse, a);
+#ifdef BLOCK_CACHE
+	for(a = addr; a < end; a++)
+		if(BLOCK_CODE(u->ram.code, a)) {
+			flushblocks(u);
+			break;
+		}
+#endif
+#ifdef UXN_AOT
+	for(a = addr; a < end; a++)
+		if(AOT_CODE(a)) {
+			aot_dirty = 1;
+			break;
+		}
+#endif
+	/* Superinstructions ending in the range may start before it. Only the
+	   program pages are scanned: STZ can write the zero page unchecked. */
+	a = addr < PAGE_PROGRAM + FUSE_SPAN - 1 ? PAGE_PROGRAM : addr - FUSE_SPAN + 1;
+	for(; a < end; a++) {
+		if(!first[ram[a]] || (fuse[a] && fuse[a] != FUSE_COVERED))
+			continue;
+		for(i = 0; i < FUSE_COUNT; i++) {
+			if(a + fusions[i].length > 0x10000)
+				continue;
+			for(j = 0; j < fusions[i].length; j++)
+				if((fusions[i].opcodes >> j & 1) && ram[a + j] != fusions[i].code[j])
+					break;
+			if(j == fusions[i].length)
+				break;
+		}
+		if(i == FUSE_COUNT)
+			continue;
+		fuse[a] = i + 1;
+		for(j = 1; j < fusions[i].length; j++)
+			if((fusions[i].opcodes >> j & 1) && !fuse[a + j])
+				fuse[a + j] = FUSE_COVERED;
+	}
 }
 
 int
@@ -4051,19 +521,34 @@ loaduxn(Uxn *u, char *filepath)
                 dprintf("Halted: Missing input rom.\n");
                 return 0;
         }
-        fread(u->ram.dat + PAGE_PROGRAM, sizeof(u->ram.dat) - PAGE_PROGRAM, 1, f);
+        /* Whatever does not fit in bank 0 goes on into the next banks. */
+        fread(u->ram.dat + PAGE_PROGRAM, 1, 65536 * UXN_BANKS - PAGE_PROGRAM, f);
+        fuseuxn(u, PAGE_PROGRAM, 65536 - PAGE_PROGRAM);
+#ifdef UXN_AOT
+        {
+                u32 h = 2166136261u, i;
+                for(i = PAGE_PROGRAM; i < 65536; i++)
+                        h = (h ^ u->ram.dat[i]) * 16777619u;
+                aot_dirty = h != AOT_ROM_HASH;
+                dprintf("Translated ROM %s.\n", aot_dirty ? "not matched" : "matched");
+        }
+#endif
         dprintf("Uxn loaded[%s].\n", filepath);
         return 1;
 }
 
+/* Bit n of rhook and whook is set for the ports n of the device that talkfn
+   has to see read or written; the others are plain memory in dat. */
 Device *
-portuxn(Uxn *u, Uint8 id, char *name, int (*talkfn)(Device *d, Uint8 b0, Uint8 w))
+portuxn(Uxn *u, Uint8 id, char *name, int (*talkfn)(Device *d, Uint8 b0, Uint8 w), Uint16 rhook, Uint16 whook)
 {
         Device *d = &u->dev[id];
         d->addr = id * 0x10;
         d->u = u;
         d->mem = u->ram.dat;
         d->talk = talkfn;
+        d->rhook = rhook;
+        d->whook = whook;
         dprintf("Device added #%02x: %s, at 0x%04x \n", id, name, d->addr);
         return d;
 }
@@ -0,0 +1,499 @@
+#!/usr/bin/env python3
+
+"""Generate the opcode handlers of runuxn() from etc/opcodes.txt.
+
+Every entry of the table is expanded into its return and keep mode variants
+and compiled against the register layout of runuxn() in arm9/source/uxn.c:
+stack accesses become indexed loads and stores relative to the wptr/rptr
+locals, the top byte of the working stack lives in wtop, writes that would
+store a popped value back into the slot it came from are dropped, and the
+stack pointers are adjusted once at the end of each handler.
+
+With --checks, every handler starts by testing the stack pointers against its
+underflow/overflow limits, which is the CPU_ERROR_CHECKING (debug) core; the
+release and profile cores are generated without them. With --block, stack
+errors still halt but the bounds are left to runuxn, which tests them once
+for a whole basic block in CPU_ERROR_CHECKING builds. The output is meant to
+be included inside the dispatch switch of runuxn().
+"""
+
+import argparse
+import os
+import re
+import sys
+
+MODE_SHORT = 0x20
+MODE_RETURN = 0x40
+MODE_KEEP = 0x80
+
+DEVICE_CALL = re.compile(r'\bdev(?:r8|r16|w8|w16)\(')
+JUMP = re.compile(r'\bpc \+?= ')
+STORE = re.compile(r'\bstore(?:8|16)\(')
+POP = re.compile(r'\bpop(8|16)\((src|dst)\)')
+PUSH = re.compile(r'^push(8|16)\((src|dst), (.*)\)$')
+FAIL = re.compile(r'^fail\((src|dst), (\d+)\)$')
+DECLARE = re.compile(r'^Uint(?:8|16) (\w+) = pop(8|16)\((src|dst)\)$')
+IDENTIFIER = re.compile(r'^\w+$')
+
+# fuse[] value of opcode bytes inside a superinstruction; see uxn.c
+FUSE_COVERED = 0xff
+
+
+def load_table(path):
+	"""Return the 64 (name, body) table entries, byte mode first, and the
+	superinstructions as lists of mnemonics."""
+	entries, fusions = [], []
+	with open(path) as f:
+		for number, line in enumerate(f, 1):
+			if not line.strip() or line.startswith('#'):
+				continue
+			if line[0].isspace():
+				if not entries:
+					sys.exit('%s:%d: continuation without an entry' % (path, number))
+				entries[-1][1] += ' ' + line.strip()
+				continue
+			name, _, body = line.strip().partition('\t')
+			if name == 'FUSE':
+				fusions.append(body.split())
+				continue
+			entries.append([name, body.strip()])
+	if len(entries) != 64:
+		sys.exit('%s: expected 64 entries, found %d' % (path, len(entries)))
+	for i in range(32):
+		if entries[i + 32][0] != entries[i][0] + '2':
+			sys.exit('%s: %s should follow the byte entries in the same order' % (path, entries[i + 32][0]))
+	return [(name, split_statements(body)) for name, body in entries], fusions
+
+
+def split_statements(text):
+	"""Split a body into statements; 'head { ... }' becomes (head, [statements])."""
+	statements, depth, start = [], 0, 0
+	for i, c in enumerate(text):
+		if c in '({':
+			depth += 1
+		elif c in ')}':
+			depth -= 1
+		if depth == 0 and c in ';}':
+			statement = text[start:i + 1].strip()
+			start = i + 1
+			if c == ';':
+				statements.append(statement[:-1].strip())
+			else:
+				head, _, inner = statement[:-1].partition('{')
+				statements.append((head.strip(), split_statements(inner)))
+	if text[start:].strip():
+		sys.exit('unterminated statement: ' + text[start:])
+	return statements
+
+
+class Stack:
+	def __init__(self, name, keep):
+		self.name = name
+		self.ptr = name[0] + 'ptr'
+		self.keep = keep
+		self.popped = 0  # offset of the next byte to pop, relative to ptr
+		self.pushed = 0  # offset of the next byte to push
+		self.need = 0  # bytes that must be on the stack
+		self.written = set()
+
+	def slot(self, offset):
+		if offset < 0:
+			return 'u->%s.dat[%s - %d]' % (self.name, self.ptr, -offset)
+		if offset > 0:
+			return 'u->%s.dat[%s + %d]' % (self.name, self.ptr, offset)
+		return 'u->%s.dat[%s]' % (self.name, self.ptr)
+
+	def pop(self):
+		self.popped -= 1
+		if not self.keep:
+			self.pushed = self.popped
+		self.need = max(self.need, -self.popped)
+		return self.popped
+
+	def push(self):
+		self.pushed += 1
+		if not self.keep:
+			self.popped = self.pushed
+		return self.pushed - 1
+
+
+class Handler:
+	"""Translates one opcode; run once to find its stack effects, then again to
+	emit code using them."""
+
+	def __init__(self, core, statements, mode, effects=None):
+		self.core = core
+		self.lines = []
+		self.bindings = {}
+		self.wtop_written = False
+		self.spilled = False
+		self.synced = False
+		keep = bool(mode & MODE_KEEP)
+		wst, rst = Stack('wst', keep), Stack('rst', keep)
+		self.src, self.dst = (rst, wst) if mode & MODE_RETURN else (wst, rst)
+		self.stacks = {'src': self.src, 'dst': self.dst}
+		self.effects = effects
+		for statement in statements:
+			self.statement(statement, self.lines)
+
+	def read(self, stack, offset):
+		if stack.name == 'wst' and offset == -1:
+			assert not self.wtop_written, 'top of stack read after it was replaced'
+			return 'wtop'
+		assert offset not in stack.written, 'stack slot read after it was written'
+		return stack.slot(offset)
+
+	def write(self, stack, offset, value, out):
+		stack.written.add(offset)
+		if self.effects is None:
+			return
+		delta, written = self.effects[stack.name]
+		if stack.name == 'wst' and offset == delta - 1:
+			# The new top of the working stack stays in wtop. When the
+			# stack grows, the old top has to be spilled to memory first,
+			# unless the handler stores something else there.
+			if delta > 0 and -1 not in written and not self.spilled:
+				out.append('if(wptr) u->wst.dat[wptr - 1] = wtop;')
+				self.spilled = True
+			if self.wtop_written or self.bindings.get(value) != ('wst', '8', -1):
+				out.append('wtop = %s;' % value)
+			self.wtop_written = True
+		else:
+			out.append('%s = %s;' % (stack.slot(offset), value))
+
+	def pop_value(self, match):
+		stack = self.stacks[match.group(2)]
+		if match.group(1) == '8':
+			return self.read(stack, stack.pop())
+		low = self.read(stack, stack.pop())
+		return '(%s | (%s << 8))' % (low, self.read(stack, stack.pop()))
+
+	def push(self, width, stack, value, out):
+		binding = self.bindings.get(value)
+		if width == '8':
+			offset = stack.push()
+			if binding != (stack.name, width, offset):
+				self.write(stack, offset, value, out)
+			return
+		high, low = stack.push(), stack.push()
+		if binding == (stack.name, width, low):
+			return
+		if not IDENTIFIER.match(value):
+			# The value is written out twice, once per byte, so that a
+			# device access has to be bound to a local first.
+			if DEVICE_CALL.search(value):
+				raise ValueError('push16 of a device access: %s' % value)
+			value = '(%s)' % value
+		self.write(stack, high, '%s >> 8' % value, out)
+		self.write(stack, low, '%s & 0xff' % value, out)
+
+	def statement(self, statement, out):
+		if isinstance(statement, tuple):
+			head, inner = statement
+			head = POP.sub(self.pop_value, head)
+			self.sync(head, out)
+			body = []
+			for s in inner:
+				self.statement(s, body)
+			out.append('%s {' % head)
+			out.extend('\t' + line for line in body)
+			out.append('}')
+			return
+		match = PUSH.match(statement)
+		if match:
+			value = POP.sub(self.pop_value, match.group(3))
+			self.sync(value, out)
+			self.push(match.group(1), self.stacks[match.group(2)], value, out)
+			return
+		match = POP.fullmatch(statement)
+		if match:
+			self.pop_value(match)
+			return
+		match = FAIL.match(statement)
+		if match:
+			out.append('u->%s.error = %s;' % (self.stacks[match.group(1)].name, match.group(2)))
+			if self.core.halts:
+				out.append('goto error;')
+			return
+		match = DECLARE.match(statement)
+		if match:
+			stack = self.stacks[match.group(3)]
+			low = stack.popped - 1
+			self.bindings[match.group(1)] = (stack.name, match.group(2), low)
+		statement = POP.sub(self.pop_value, statement)
+		self.sync(statement, out)
+		out.append(statement + ';')
+
+	def sync(self, code, out):
+		# Devices can look at the whole machine state, so write the locals
+		# back before the first device access.
+		if not self.synced and DEVICE_CALL.search(code):
+			out.append('SYNC();')
+			self.synced = True
+
+	def checks(self):
+		lines = []
+		for stack in (self.src, self.dst):
+			delta = stack.pushed
+			if stack.need:
+				lines += [
+					'if(__builtin_expect(%s < %d, 0)) {' % (stack.ptr, stack.need),
+					'\tu->%s.error = 1;' % stack.name,
+					'\tgoto error;',
+					'}']
+			if delta > 0:
+				lines += [
+					'if(__builtin_expect(%s > %d, 0)) {' % (stack.ptr, 255 - delta),
+					'\tu->%s.error = 2;' % stack.name,
+					'\tgoto error;',
+					'}']
+		return lines
+
+	def epilogue(self):
+		lines = []
+		for stack in (self.src, self.dst):
+			delta = stack.pushed
+			if delta:
+				lines.append('%s %s= %d;' % (stack.ptr, '+' if delta > 0 else '-', abs(delta)))
+			if stack.name == 'wst' and delta < 0 and delta - 1 not in stack.written:
+				lines.append('wtop = u->wst.dat[wptr - 1];')
+		return lines
+
+
+class Core:
+	def __init__(self, table, fusions, checks, block=False):
+		self.table = table
+		self.checks = checks
+		self.block = block
+		self.halts = checks or block
+		self.opcodes = {self.opcode_name(opcode): opcode for opcode in range(1, 256)}
+		# The assembler writes literals with the keep flag set, since
+		# 0x00 is BRK; accept its spelling of them too.
+		for opcode in range(MODE_KEEP, 256, MODE_SHORT):
+			self.opcodes[self.opcode_name(opcode & ~MODE_KEEP)] = opcode
+		self.fusions = []
+		for names in fusions:
+			if len(names) < 2 or any(name not in self.opcodes for name in names):
+				sys.exit('bad superinstruction: ' + ' '.join(names))
+			fusion = [self.opcodes[name] for name in names]
+			# The block cache and the store tracking rely on nothing
+			# following a jump, device access or store in the sequence.
+			if any(self.ends(opcode) or self.stores(opcode) for opcode in fusion[:-1]):
+				sys.exit('superinstruction can only end in a jump, device access or store: ' + ' '.join(names))
+			self.fusions.append(fusion)
+		if len(self.fusions) >= FUSE_COVERED:
+			sys.exit('too many superinstructions')
+
+	def body(self, opcode):
+		return repr(self.table[opcode & 0x3f][1])
+
+	def ends(self, opcode):
+		"""Whether a basic block ends after the opcode."""
+		return opcode == 0x00 or bool(JUMP.search(self.body(opcode)) or DEVICE_CALL.search(self.body(opcode)))
+
+	def stores(self, opcode):
+		return bool(STORE.search(self.body(opcode)))
+
+	def next(self, opcodes):
+		"""How a handler continues: in the block core, a handler that ends
+		the block goes back to runuxn for the next one, and one that
+		stores to memory does so if the store dropped the block cache."""
+		if self.block and any(self.ends(opcode) for opcode in opcodes):
+			return 'NEXT_BLOCK;'
+		if self.block and any(self.stores(opcode) for opcode in opcodes):
+			return 'NEXT_STORE;'
+		return 'NEXT;'
+
+	def opcode_name(self, opcode):
+		name = self.table[opcode & 0x3f][0]
+		return name + ('k' if opcode & MODE_KEEP else '') + ('r' if opcode & MODE_RETURN else '')
+
+	def fusion_bytes(self, fusion):
+		"""The bytes a superinstruction spans, None for literal data."""
+		code = []
+		for opcode in fusion:
+			code.append(opcode)
+			if opcode & 0x1f == 0x00:
+				code += [None] * (2 if opcode & MODE_SHORT else 1)
+		return code
+
+	def fusion_name(self, fusion):
+		return ' '.join(self.opcode_name(opcode & ~MODE_KEEP if opcode & 0x1f == 0x00 else opcode)
+			for opcode in fusion)
+
+	def fused_handler(self, id, fusion):
+		out = ['case %d: /* %s */' % (id, self.fusion_name(fusion))]
+		out.append('\tCOUNT_FUSED(%d);' % (len(fusion) - 1))
+		for i, opcode in enumerate(fusion):
+			# Step over the opcode byte as its own dispatch would have,
+			# so that pc is exact for jumps, JSR and device handlers.
+			if i:
+				out.append('\tpc++;')
+				out.append('\tPROFILE_OPCODE(0x%02x, pc - 1);' % opcode)
+			out.append('\t{')
+			out.extend('\t\t' + line for line in self.handler(opcode))
+			out.append('\t}')
+		if any(JUMP.search(self.body(opcode)) for opcode in fusion):
+			out.append('\tCHECK_BUDGET;')
+		out.append('\t' + self.next(fusion))
+		return out
+
+	def handler(self, opcode):
+		statements = self.table[opcode & 0x3f][1]
+		first = Handler(self, statements, opcode)
+		effects = {s.name: (s.pushed, s.written) for s in (first.src, first.dst)}
+		handler = Handler(self, statements, opcode, effects)
+		body = (first.checks() if self.checks else []) + handler.lines + handler.epilogue()
+		return body
+
+	def generate(self):
+		out = []
+		for opcode in range(256):
+			labels = [opcode]
+			if opcode & 0x1f == 0x00:
+				# LIT ignores the keep flag and 0x00 is BRK, which
+				# runuxn handles itself: 0x20, 0x40 and 0x60 share
+				# their handler with the keep variant.
+				if opcode & MODE_KEEP:
+					if opcode != MODE_KEEP:
+						continue
+				else:
+					labels = [opcode, opcode | MODE_KEEP] if opcode else []
+			for label in labels:
+				out.append('\t\tOPCODE(0x%02x): /* %s */' % (label, self.opcode_name(label)))
+			if not labels:
+				continue
+			fused = [(id, fusion) for id, fusion in enumerate(self.fusions, 1) if fusion[0] in labels]
+			if fused:
+				# The predecoder marks where a superinstruction starts.
+				out.append('\t\t\tswitch(fuse[pc - 1]) {')
+				for id, fusion in fused:
+					out.extend('\t\t\t' + line for line in self.fused_handler(id, fusion))
+				out.append('\t\t\t}')
+			body = self.handler(opcode)
+			if body:
+				out.append('\t\t\t{')
+				out.extend('\t\t\t\t' + line for line in body)
+				out.append('\t\t\t}')
+			if JUMP.search(self.body(opcode)):
+				out.append('\t\t\tCHECK_BUDGET;')
+			out.append('\t\t\t' + self.next([opcode]))
+		return out
+
+	def effects(self, opcode):
+		"""Bytes needed on and net change of the working and return stacks,
+		length in bytes and whether a basic block ends after the opcode."""
+		if opcode == 0x00:
+			return 0, 0, 0, 0, 1, 1
+		if opcode & 0x1f == 0x00:
+			opcode |= MODE_KEEP
+		statements = self.table[opcode & 0x3f][1]
+		handler = Handler(self, statements, opcode)
+		wst, rst = (handler.dst, handler.src) if opcode & MODE_RETURN else (handler.src, handler.dst)
+		length = 1
+		if opcode & 0x1f == 0x00:
+			length += 2 if opcode & MODE_SHORT else 1
+		return wst.need, wst.pushed, rst.need, rst.pushed, length, int(self.ends(opcode))
+
+	def generate_tables(self):
+		span = max(len(self.fusion_bytes(fusion)) for fusion in self.fusions)
+		out = [
+			'#define FUSE_COUNT %d' % len(self.fusions),
+			'#define FUSE_SPAN %d' % span,
+			'',
+			'/* Superinstruction i + 1: its length in bytes, which of them are',
+			'   opcodes (bit n for byte n) and the opcodes themselves. */',
+			'static const struct {',
+			'\tUint8 length, opcodes, code[FUSE_SPAN];',
+			'} fusions[FUSE_COUNT] = {']
+		for fusion in self.fusions:
+			code = self.fusion_bytes(fusion)
+			mask = sum(1 << i for i, byte in enumerate(code) if byte is not None)
+			out.append('\t{%d, 0x%02x, {%s}}, /* %s */' % (len(code), mask,
+				', '.join('0x%02x' % (byte or 0) for byte in code), self.fusion_name(fusion)))
+		out += [
+			'};',
+			'',
+			'/* Stack effect of every opcode for the block cache: the bytes it needs',
+			'   on and its net change to the working and return stacks, its length',
+			'   and whether a basic block ends after it - jumps, device access and',
+			'   BRK. */',
+			'static const struct {',
+			'\tUint8 wneed;',
+			'\tSint8 wdelta;',
+			'\tUint8 rneed;',
+			'\tSint8 rdelta;',
+			'\tUint8 length, ends;',
+			'} effects[256] = {']
+		for opcode in range(256):
+			name = 'BRK' if opcode == 0 else self.opcode_name(opcode)
+			out.append('\t{%d, %d, %d, %d, %d, %d}, /* %s */' % (self.effects(opcode) + (name,)))
+		out.append('};')
+		return out
+
+
+HEADER = '''/*
+ ^
+/!\\ THIS FILE IS AUTOMATICALLY GENERATED
+---
+
+Generated by etc/mkuxn.py from etc/opcodes.txt (%s core); edit those instead.
+It is included into the dispatch switch of runuxn() in arm9/source/uxn.c.
+
+*/
+
+#if%sdef NO_STACK_CHECKS
+#error "%s"
+#endif
+
+'''
+
+
+FUSE_HEADER = '''/*
+ ^
+/!\\ THIS FILE IS AUTOMATICALLY GENERATED
+---
+
+Generated by etc/mkuxn.py from etc/opcodes.txt; edit those instead.
+The superinstructions that fuseuxn() in arm9/source/uxn.c looks for, and the
+opcode stack effects its block cache is built from.
+
+*/
+
+'''
+
+
+def main():
+	here = os.path.dirname(os.path.abspath(__file__))
+	parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+	parser.add_argument('table', nargs='?', default=os.path.join(here, 'opcodes.txt'))
+	parser.add_argument('-o', '--output', help='output file (default: stdout)')
+	parser.add_argument('--checks', action='store_true',
+		help='generate stack bounds checks (CPU_ERROR_CHECKING core)')
+	parser.add_argument('--block', action='store_true',
+		help='generate the core run inside checked basic blocks')
+	parser.add_argument('--fusions', action='store_true',
+		help='generate the predecoder tables: superinstructions and stack effects')
+	args = parser.parse_args()
+
+	core = Core(*load_table(args.table), args.checks, args.block)
+	if args.fusions:
+		header = FUSE_HEADER
+		text = header + '\n'.join(core.generate_tables()) + '\n'
+	elif args.checks:
+		header = HEADER % ('checked', '', 'this core was generated with --checks; build it with CPU_ERROR_CHECKING')
+	elif args.block:
+		header = HEADER % ('block', '', 'the block core is only used by CPU_ERROR_CHECKING builds')
+	else:
+		header = HEADER % ('unchecked', 'n', 'CPU_ERROR_CHECKING needs a core generated with --checks')
+	if not args.fusions:
+		text = header + '\n'.join(core.generate()) + '\n'
+	if args.output:
+		with open(args.output, 'w') as f:
+			f.write(text)
+	else:
+		sys.stdout.write(text)
+
+
+if __name__ == '__main__':
+	main()
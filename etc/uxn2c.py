@@ -0,0 +1,397 @@
+#!/usr/bin/env python3
+
+"""Translate a uxn ROM ahead of time into C functions for uxn.c.
+
+The code reachable from the reset vector, and from every vector the program
+installs with the usual "LIT2 addr LIT port DEO2" sequence, is followed
+statically; each of those vectors becomes a C function with a label at every
+address it can be jumped into. The instructions are the handlers etc/mkuxn.py
+generates for the release core, so they behave exactly like the interpreter,
+except that within a basic block they work on C locals standing for the stack
+slots, which the compiler can keep in registers. Literal data is read from
+memory as it runs, as uxntal programs routinely store into their own LIT
+operands.
+
+Jumps are the only place where the translation guesses: their target is
+compared against the one the ROM was written with, falling back to a switch
+over the entry points of the function, and to runuxn() at any address the
+translation did not reach. Every jump also counts against the budget of
+the vector; a vector that runs out is suspended, and entered again through
+the same switch when it is resumed. The output is included into arm9/source/uxn.c
+for builds with UXN_AOT, which run it only while memory still holds the ROM
+it was made from and no store has touched a translated opcode byte.
+"""
+
+import argparse
+import os
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from mkuxn import Core, DEVICE_CALL, Handler, JUMP, MODE_KEEP, MODE_RETURN, MODE_SHORT, load_table  # noqa: E402
+
+PAGE_PROGRAM = 0x0100
+
+JMP, JCN, JSR = 0x0c, 0x0d, 0x0e
+DEO2 = 0x37
+LIT, LIT2 = 0x80, 0xa0
+
+
+def length(opcode):
+	if opcode & 0x1f == 0x00 and opcode:
+		return 3 if opcode & MODE_SHORT else 2
+	return 1
+
+
+def fnv1a(data):
+	h = 2166136261
+	for byte in data:
+		h = ((h ^ byte) * 16777619) & 0xffffffff
+	return h
+
+
+class Block:
+	"""The stack slots a basic block has touched, kept in C locals named by
+	their offset from the stack pointer at the start of the block. They are
+	written back, and the stack pointers moved, where the block ends or hands
+	over to code that looks at the stacks in memory."""
+
+	def __init__(self):
+		self.names = set()
+		self.reset()
+
+	def reset(self):
+		self.delta = {'wst': 0, 'rst': 0}
+		self.slots = {}  # (stack, offset) -> whether it was written
+
+	def var(self, stack, offset):
+		name = '%s%s%d' % (stack[0], 'm' if offset < 0 else 'p', abs(offset))
+		self.names.add(name)
+		return name
+
+	def index(self, stack, offset):
+		ptr = stack[0] + 'ptr'
+		return ptr if not offset else '%s %s %d' % (ptr, '-' if offset < 0 else '+', abs(offset))
+
+	def read(self, stack, offset, out):
+		if (stack, offset) not in self.slots:
+			out.append('%s = u->%s.dat[%s];' % (self.var(stack, offset), stack, self.index(stack, offset)))
+			self.slots[stack, offset] = False
+		return self.var(stack, offset)
+
+	def write(self, stack, offset, value, out):
+		out.append('%s = %s;' % (self.var(stack, offset), value))
+		self.slots[stack, offset] = True
+
+	def store(self, out):
+		"""Write the slots back, leaving the locals in use."""
+		for (stack, offset), written in sorted(self.slots.items()):
+			if written:
+				out.append('u->%s.dat[%s] = %s;' % (stack, self.index(stack, offset), self.var(stack, offset)))
+				self.slots[stack, offset] = False
+
+	def flush(self):
+		"""The code bringing the stacks up to date, for a path leaving the
+		block; the block itself goes on as it was."""
+		out = []
+		for (stack, offset), written in sorted(self.slots.items()):
+			# Slots popped again by the end of the block are dead.
+			if written and offset < self.delta[stack]:
+				out.append('u->%s.dat[%s] = %s;' % (stack, self.index(stack, offset), self.var(stack, offset)))
+		for stack in ('wst', 'rst'):
+			if self.delta[stack]:
+				out.append('%sptr %s= %d;' % (stack[0], '+' if self.delta[stack] > 0 else '-', abs(self.delta[stack])))
+		return out
+
+	def commit(self, out):
+		out.extend(self.flush())
+		self.reset()
+
+
+class Translation(Handler):
+	"""One instruction of a block, working on its locals rather than on the
+	registers of runuxn."""
+
+	def __init__(self, core, statements, mode, block):
+		self.block = block
+		self.out = None
+		super().__init__(core, statements, mode)
+		for stack in (self.src, self.dst):
+			block.delta[stack.name] += stack.pushed
+
+	def statement(self, statement, out):
+		outer, self.out = self.out, out
+		super().statement(statement, out)
+		self.out = outer
+
+	def read(self, stack, offset):
+		assert self.out is not None
+		return self.block.read(stack.name, self.block.delta[stack.name] + offset, self.out)
+
+	def write(self, stack, offset, value, out):
+		self.block.write(stack.name, self.block.delta[stack.name] + offset, value, out)
+
+	def sync(self, code, out):
+		# Devices see the machine as it was before the instruction.
+		if not self.synced and DEVICE_CALL.search(code):
+			self.block.store(out)
+			out.append('u->ram.ptr = pc;')
+			for stack in ('wst', 'rst'):
+				out.append('u->%s.ptr = %s;' % (stack, self.block.index(stack, self.block.delta[stack])))
+			self.synced = True
+
+
+class Program:
+	def __init__(self, core, ram):
+		self.core = core
+		self.ram = ram
+
+	def literal(self, addr, opcode):
+		"""The value a jump at addr is statically known to take off the
+		stack: that of the literal right before it, if there is one."""
+		width = 2 if opcode & MODE_SHORT else 1
+		lit = addr - 1 - width
+		if opcode & MODE_KEEP or lit < PAGE_PROGRAM:
+			return None
+		if self.ram[lit] != (LIT | (MODE_SHORT if width == 2 else 0) | (opcode & MODE_RETURN)):
+			return None
+		if width == 2:
+			return self.ram[lit + 1] << 8 | self.ram[lit + 2]
+		return self.ram[lit + 1]
+
+	def target(self, addr):
+		"""Where the jump at addr goes when its operand is the literal it
+		was assembled with, or None."""
+		opcode = self.ram[addr]
+		value = self.literal(addr, opcode)
+		if value is None:
+			return None
+		if opcode & MODE_SHORT:
+			return value
+		return (addr + 1 + (value - 256 if value & 0x80 else value)) & 0xffff
+
+	def trace(self, entry):
+		"""The instructions reachable from entry, and the addresses that can
+		be jumped to: the entry, jump targets and return sites."""
+		seen, leaders, work = set(), {entry}, [entry]
+		while work:
+			addr = work.pop()
+			while addr not in seen and PAGE_PROGRAM <= addr < 0x10000:
+				opcode = self.ram[addr]
+				seen.add(addr)
+				following = addr + length(opcode)
+				if opcode == 0x00:
+					break
+				if JUMP.search(self.core.body(opcode)):
+					target = self.target(addr)
+					if target is not None:
+						leaders.add(target)
+						work.append(target)
+					if opcode & 0x1f not in (JCN, JSR):
+						break
+					leaders.add(following)
+				addr = following
+		return seen, leaders
+
+	def vectors(self, code):
+		"""Vectors installed by the code: LIT2 addr LIT port DEO2, with the
+		port being the vector of a device."""
+		found = set()
+		for addr in code:
+			if self.ram[addr] != LIT2 or addr + 5 >= 0x10000:
+				continue
+			if self.ram[addr + 3] == LIT and self.ram[addr + 4] & 0x0f == 0 and self.ram[addr + 5] == DEO2:
+				vector = self.ram[addr + 1] << 8 | self.ram[addr + 2]
+				if vector >= PAGE_PROGRAM:
+					found.add(vector)
+		return found
+
+	def functions(self):
+		functions, work = {}, [PAGE_PROGRAM]
+		while work:
+			vector = work.pop()
+			if vector in functions:
+				continue
+			functions[vector] = self.trace(vector)
+			work += sorted(self.vectors(functions[vector][0]) - set(functions))
+		return functions
+
+	def instruction(self, addr, code, labels, block):
+		opcode = self.ram[addr]
+		name = 'BRK' if opcode == 0x00 else self.core.opcode_name(opcode)
+		after = (addr + length(opcode)) & 0xffff
+		out = []
+		if addr in labels:
+			# Other code jumps here with the stacks in memory.
+			block.commit(out)
+			out.append('a_%04x: /* %s */' % (addr, name))
+		else:
+			out.append('/* %04x %s */' % (addr, name))
+		out.append('COUNT_OPCODE(0x%02x, 0x%04x);' % (opcode, addr))
+		if opcode == 0x00:
+			block.commit(out)
+			return out + ['pc = 0x%04x;' % after, 'goto brk;']
+		statements = self.core.table[opcode & 0x3f][1]
+		body = Translation(self.core, statements, opcode, block).lines
+		if any('pc' in line for line in body):
+			out.append('pc = 0x%04x;' % ((addr + 1) & 0xffff))
+		if body:
+			out.append('{')
+			out.extend('\t' + line for line in body)
+			out.append('}')
+		if JUMP.search(self.core.body(opcode)):
+			block.commit(out)
+			out.append('if(!--budget) goto suspend;')
+			target = self.target(addr)
+			if target is not None and target in labels:
+				out.append('if(pc == 0x%04x) goto a_%04x;' % (target, target))
+			if opcode & 0x1f == JCN and after in labels:
+				out.append('if(pc == 0x%04x) goto a_%04x;' % (after, after))
+			out.append('goto dispatch;')
+			return out
+		if self.core.stores(opcode) or self.core.ends(opcode):
+			# A store or device into translated code leaves the rest of
+			# the vector to the interpreter.
+			out.append('if(aot_dirty) {')
+			out.extend('\t' + line for line in block.flush())
+			out.append('\tpc = 0x%04x;' % after)
+			out.append('\tgoto bail;')
+			out.append('}')
+		return out
+
+	def function(self, vector, code, leaders):
+		addrs = sorted(code)
+		labels = leaders & code
+		jumps = {}
+		for i, addr in enumerate(addrs):
+			opcode = self.ram[addr]
+			after = (addr + length(opcode)) & 0xffff
+			if opcode == 0x00 or JUMP.search(self.core.body(opcode)):
+				continue
+			if i + 1 == len(addrs) or addrs[i + 1] != after:
+				jumps[addr] = after
+				labels.add(after)
+		block = Block()
+		body = []
+		for addr in addrs:
+			body.extend(self.instruction(addr, code, labels, block))
+			if addr in jumps:
+				block.commit(body)
+				if jumps[addr] in code:
+					body.append('goto a_%04x;' % jumps[addr])
+				else:
+					body += ['pc = 0x%04x;' % jumps[addr], 'goto bail;']
+		out = [
+			'static int',
+			'aot_%04x(Uxn *u, Uint16 *resume)' % vector,
+			'{',
+			'\tUint8 wptr = u->wst.ptr, rptr = u->rst.ptr;',
+			'\tUint8 *ram = u->ram.dat, *fuse = u->ram.fuse;',
+			'\tUint16 pc = *resume;',
+			'\tu32 budget = u->budget;']
+		if block.names:
+			out.append('\tUint8 %s;' % ', '.join(sorted(block.names)))
+		# A suspended vector goes on from any of the entry points.
+		out.append('\tif(pc != 0x%04x) goto dispatch;' % vector)
+		out.append('\tgoto a_%04x;' % vector)
+		out.extend(line if line.endswith(':') or ': /*' in line else '\t' + line for line in body)
+		out.append('dispatch:')
+		out.append('\tswitch(pc) {')
+		for addr in sorted(leaders & code):
+			out.append('\tcase 0x%04x: goto a_%04x;' % (addr, addr))
+		out += [
+			'\t}',
+			'bail:',
+			'\tAOT_SYNC();',
+			'\t*resume = pc;',
+			'\treturn -1;',
+			'brk:',
+			'\tAOT_SYNC();',
+			'\treturn 1;',
+			'suspend:',
+			'\tAOT_SYNC();',
+			'\treturn UXN_SUSPENDED;',
+			'}',
+			'']
+		return out
+
+	def generate(self, name):
+		functions = self.functions()
+		bitmap = bytearray(65536 // 8)
+		for code, _ in functions.values():
+			for addr in code:
+				bitmap[addr >> 3] |= 1 << (addr & 7)
+		out = [
+			'#define AOT_ROM_HASH 0x%08x /* %s */' % (fnv1a(self.ram[PAGE_PROGRAM:]), name),
+			'',
+			'/* Opcode bytes the functions below were translated from. */',
+			'static const Uint8 aot_code[65536 / 8] = {']
+		for i in range(0, len(bitmap), 16):
+			out.append('\t' + ' '.join('0x%02x,' % byte for byte in bitmap[i:i + 16]))
+		out += ['};', '', '#pragma GCC diagnostic push',
+			'#pragma GCC diagnostic ignored "-Wunused-label"',
+			'#pragma GCC diagnostic ignored "-Wunused-variable"',
+			'#pragma GCC diagnostic ignored "-Wunused-value"',
+			'#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"', '']
+		for vector in sorted(functions):
+			out += self.function(vector, *functions[vector])
+		out += ['#pragma GCC diagnostic pop', '',
+			'/* Translated vectors, by address. */',
+			'static const struct {',
+			'\tUint16 vector;',
+			'\tint (*run)(Uxn *u, Uint16 *resume);',
+			'} aot_vectors[] = {']
+		for vector in sorted(functions):
+			out.append('\t{0x%04x, aot_%04x},' % (vector, vector))
+		out.append('};')
+		return out, functions
+
+
+HEADER = '''/*
+ ^
+/!\\ THIS FILE IS AUTOMATICALLY GENERATED
+---
+
+Generated by etc/uxn2c.py from %s; regenerate it instead of editing.
+It is included into arm9/source/uxn.c by builds with UXN_AOT.
+
+*/
+
+#ifndef NO_STACK_CHECKS
+#error "the translated ROM has no stack checks; build it without CPU_ERROR_CHECKING"
+#endif
+
+'''
+
+
+def main():
+	here = os.path.dirname(os.path.abspath(__file__))
+	parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+	parser.add_argument('rom')
+	parser.add_argument('-o', '--output', help='output file (default: stdout)')
+	parser.add_argument('--table', default=os.path.join(here, 'opcodes.txt'),
+		help='opcode table (default: %(default)s)')
+	parser.add_argument('-v', '--verbose', action='store_true',
+		help='list the translated vectors on stderr')
+	args = parser.parse_args()
+
+	with open(args.rom, 'rb') as f:
+		rom = f.read(0x10000 - PAGE_PROGRAM)
+	ram = bytearray(0x10000)
+	ram[PAGE_PROGRAM:PAGE_PROGRAM + len(rom)] = rom
+	core = Core(*load_table(args.table), False)
+	name = os.path.basename(args.rom)
+	lines, functions = Program(core, ram).generate(name)
+	if args.verbose:
+		for vector in sorted(functions):
+			code, leaders = functions[vector]
+			sys.stderr.write('vector 0x%04x: %d instructions, %d entry points\n' % (vector, len(code), len(leaders & code)))
+	text = HEADER % name + '\n'.join(lines) + '\n'
+	if args.output:
+		with open(args.output, 'w') as f:
+			f.write(text)
+	else:
+		sys.stdout.write(text)
+
+
+if __name__ == '__main__':
+	main()
@@ -0,0 +1,178 @@
+#!/usr/bin/env python3
+
+"""Report the profile.bin or samples.bin written by uxnds_profile.nds.
+
+With the .sym file uxnasm writes next to the ROM, the count of every address
+goes to the label at or before it, so that the report lists the hottest
+routines of the program; without one, it lists the hottest addresses. For
+profile.bin, the opcode histogram follows, with the names of etc/opcodes.txt.
+
+samples.bin holds what the sampling profiler found at each timer interrupt:
+the vector being run, the address in it and the top of the return stack.
+With --folded, each sample becomes a call stack of the vector, the callers
+found on the return stack and the sampled label, in the folded format of
+flamegraph.pl. Data kept on the return stack looks like return addresses as
+well; with --rom, only addresses right after a JSR are taken for one.
+"""
+
+import argparse
+import bisect
+import os
+import struct
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from mkuxn import Core, MODE_KEEP, load_table  # noqa: E402
+
+MAGIC = b'UXNPROF1'
+SAMPLES_MAGIC = b'UXNSAMP1'
+SAMPLE = struct.Struct('<HHBx16s')  # Sample in arm9/source/emulator.c
+PAGE_PROGRAM = 0x0100
+JSR, JSR2 = 0x0e, 0x2e
+
+
+def load_profile(data, path):
+	if len(data) != len(MAGIC) + 4 * (256 + 65536):
+		sys.exit('%s: truncated profile.bin' % path)
+	counts = struct.unpack('<%dI' % (256 + 65536), data[len(MAGIC):])
+	return counts[:256], counts[256:]
+
+
+def load_samples(data):
+	body = data[len(SAMPLES_MAGIC):]
+	body = body[:len(body) - len(body) % SAMPLE.size]
+	for vector, pc, depth, rst in SAMPLE.iter_unpack(body):
+		yield vector, pc, rst[:depth]
+
+
+def load_symbols(path):
+	"""The labels of a uxnasm .sym file, sorted by address: each is a
+	big-endian address followed by the NUL-terminated name."""
+	with open(path, 'rb') as f:
+		data = f.read()
+	symbols, i = [], 0
+	while i + 2 < len(data):
+		end = data.index(b'\0', i + 2)
+		symbols.append((data[i] << 8 | data[i + 1], data[i + 2:end].decode('latin-1')))
+		i = end + 1
+	return sorted(symbols)
+
+
+class Symbols:
+	def __init__(self, symbols, routines):
+		self.starts = [addr for addr, _ in symbols]
+		self.names = [name.split('/')[0] if routines else name for _, name in symbols]
+
+	def name(self, addr):
+		"""The label at or before addr, or the address itself."""
+		i = bisect.bisect_right(self.starts, addr) - 1
+		return '%04x' % addr if i < 0 else self.names[i]
+
+
+def by_label(addrs, symbols):
+	totals = {}
+	for addr, count in enumerate(addrs):
+		if count:
+			name = symbols.name(addr)
+			totals[name] = totals.get(name, 0) + count
+	return totals
+
+
+def callers(rst, rom):
+	"""The return addresses on top of the return stack, outermost first."""
+	found, i = [], len(rst)
+	while i >= 2:
+		addr = rst[i - 2] << 8 | rst[i - 1]
+		if rom is not None:
+			opcode = rom[addr - 1 - PAGE_PROGRAM] if PAGE_PROGRAM < addr <= PAGE_PROGRAM + len(rom) else None
+			if opcode is None or opcode & 0x3f not in (JSR, JSR2):
+				i -= 1
+				continue
+		elif addr <= PAGE_PROGRAM:
+			i -= 1
+			continue
+		found.append(addr)
+		i -= 2
+	return found[::-1]
+
+
+def folded(samples, symbols, rom):
+	stacks = {}
+	for vector, pc, rst in samples:
+		if not vector:
+			stack = '[idle]'
+		else:
+			# A return address names the routine that made the call.
+			frames = [symbols.name(vector)] + [symbols.name(addr - 1) for addr in callers(rst, rom)]
+			stack = ';'.join(frames + [symbols.name(pc)])
+		stacks[stack] = stacks.get(stack, 0) + 1
+	return stacks
+
+
+def report(title, totals, total, limit):
+	print(title)
+	rows = sorted(totals.items(), key=lambda item: -item[1])
+	for name, count in rows[:limit] if limit else rows:
+		print('%12d %6.2f%%  %s' % (count, count * 100.0 / total, name))
+	print()
+
+
+def main():
+	here = os.path.dirname(os.path.abspath(__file__))
+	parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+	parser.add_argument('profile', help='profile.bin or samples.bin')
+	parser.add_argument('-s', '--sym', help='the .sym file of the profiled ROM')
+	parser.add_argument('-r', '--routines', action='store_true',
+		help='count sub-labels towards the label they belong to')
+	parser.add_argument('-n', '--limit', type=int, default=30,
+		help='rows per table, 0 for all (default: %(default)s)')
+	parser.add_argument('-f', '--folded', action='store_true',
+		help='write the samples as folded call stacks')
+	parser.add_argument('--rom', help='the profiled ROM, to tell return addresses from data')
+	parser.add_argument('--table', default=os.path.join(here, 'opcodes.txt'),
+		help='opcode table (default: %(default)s)')
+	args = parser.parse_args()
+
+	with open(args.profile, 'rb') as f:
+		data = f.read()
+	symbols = Symbols(load_symbols(args.sym) if args.sym else [], args.routines)
+	if data.startswith(SAMPLES_MAGIC):
+		samples = list(load_samples(data))
+		if not samples:
+			sys.exit('%s: no samples' % args.profile)
+		rom = None
+		if args.rom:
+			with open(args.rom, 'rb') as f:
+				rom = f.read(0x10000 - PAGE_PROGRAM)
+		if args.folded:
+			for stack, count in sorted(folded(samples, symbols, rom).items()):
+				print('%s %d' % (stack, count))
+			return
+		print('%d samples\n' % len(samples))
+		flat = {}
+		for vector, pc, _ in samples:
+			name = symbols.name(pc) if vector else '[idle]'
+			flat[name] = flat.get(name, 0) + 1
+		report('By label:' if args.sym else 'By address:', flat, len(samples), args.limit)
+		return
+	if not data.startswith(MAGIC):
+		sys.exit('%s: not a profile.bin or samples.bin' % args.profile)
+
+	opcodes, addrs = load_profile(data, args.profile)
+	total = sum(opcodes)
+	if not total:
+		sys.exit('%s: no instructions counted' % args.profile)
+	print('%d instructions\n' % total)
+	report('By label:' if args.sym else 'By address:', by_label(addrs, symbols), total, args.limit)
+	core = Core(*load_table(args.table), False)
+	names = {}
+	for opcode, count in enumerate(opcodes):
+		if count:
+			# LIT is assembled with the keep flag set, which it ignores.
+			name = core.opcode_name(opcode & ~MODE_KEEP if opcode & 0x1f == 0x00 else opcode)
+			names['BRK' if not opcode else name] = count
+	report('By opcode:', names, total, args.limit)
+
+
+if __name__ == '__main__':
+	main()
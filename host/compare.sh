@@ -0,0 +1,58 @@
+#!/bin/sh
+#
+# Compare two host build configurations over a ROM corpus.
+#
+#   host/compare.sh [-f frames] "<make vars A>" "<make vars B>" rom...
+#
+# e.g. host/compare.sh "" "THREADED=true" roms/*.rom
+#
+# Each configuration is built from scratch, every ROM is run for the same
+# number of frames and the instruction throughput of B is reported relative
+# to A. A differing picture hash means the two builds drew different output.
+
+FRAMES=600
+if [ "$1" = "-f" ]; then
+	FRAMES=$2
+	shift 2
+fi
+if [ $# -lt 3 ]; then
+	echo "usage: $0 [-f frames] \"<make vars A>\" \"<make vars B>\" rom..." >&2
+	exit 1
+fi
+
+HOSTDIR=$(cd "$(dirname "$0")" && pwd)
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+
+for cfg in a b; do
+	if [ $cfg = a ]; then VARS=$1; else VARS=$2; fi
+	make -s -C "$HOSTDIR" clean >/dev/null
+	make -s -C "$HOSTDIR" $VARS >/dev/null 2>&1 || exit 1
+	cp "$HOSTDIR/uxnds_host" "$TMP/$cfg"
+done
+make -s -C "$HOSTDIR" clean >/dev/null
+A=$1
+B=$2
+shift 2
+
+field() {
+	sed -n "s/^$1: *//p" "$2"
+}
+
+printf "%-24s %12s %12s %8s %10s %10s\n" "rom" "A M/s" "B M/s" "speedup" "A p90 us" "B p90 us"
+for rom in "$@"; do
+	"$TMP/a" -f "$FRAMES" "$rom" > "$TMP/a.out" || exit 1
+	"$TMP/b" -f "$FRAMES" "$rom" > "$TMP/b.out" || exit 1
+	ma=$(field instructions "$TMP/a.out" | sed 's/.*(\([0-9.]*\) M\/s)/\1/')
+	mb=$(field instructions "$TMP/b.out" | sed 's/.*(\([0-9.]*\) M\/s)/\1/')
+	pa=$(field "frame time us" "$TMP/a.out" | sed 's/.*p90 \([0-9.]*\),.*/\1/')
+	pb=$(field "frame time us" "$TMP/b.out" | sed 's/.*p90 \([0-9.]*\),.*/\1/')
+	printf "%-24s %12s %12s %7.2fx %10s %10s" "$(basename "$rom")" "$ma" "$mb" \
+		"$(echo "$ma $mb" | awk '{ print ($1 > 0) ? $2 / $1 : 0 }')" "$pa" "$pb"
+	if [ "$(field "picture hash" "$TMP/a.out")" != "$(field "picture hash" "$TMP/b.out")" ]; then
+		printf "  (display differs)"
+	fi
+	printf "\n"
+done
+echo "A: ${A:-default}"
+echo "B: ${B:-default}"
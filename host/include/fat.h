@@ -0,0 +1,9 @@
+#ifndef UXNDS_HOST_FAT_H
+#define UXNDS_HOST_FAT_H
+
+#include <stdbool.h>
+
+/* The host build reads ROMs and files straight from the host filesystem. */
+bool fatInitDefault(void);
+
+#endif
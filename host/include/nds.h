@@ -0,0 +1,178 @@
+#ifndef UXNDS_HOST_NDS_H
+#define UXNDS_HOST_NDS_H
+
+/* Minimal libnds stand-in for the headless host build. Only the subset used
+   by arm9/source is provided: VRAM, palette and registers are plain RAM,
+   timers follow the host clock, and input is fed from the runner's script. */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+typedef int8_t s8;
+typedef int16_t s16;
+typedef int32_t s32;
+typedef volatile uint16_t vu16;
+typedef volatile uint32_t vu32;
+
+#define DTCM_DATA
+#define DTCM_BSS
+#define ITCM_CODE
+
+#define iprintf printf
+
+/* video */
+
+#define POWER_ALL_2D 0
+#define MODE_0_2D 0
+#define DISPLAY_BG0_ACTIVE (1 << 8)
+#define DISPLAY_BG1_ACTIVE (1 << 9)
+#define VRAM_A_MAIN_BG 0
+#define VRAM_C_SUB_BG 0
+
+#define BG_32x32 0
+#define BG_COLOR_16 0
+#define BG_PRIORITY_2 2
+#define BG_PRIORITY_3 3
+#define BG_TILE_BASE(n) ((n) << 2)
+#define BG_MAP_BASE(n) ((n) << 8)
+
+#define RGB15(r, g, b) ((r) | ((g) << 5) | ((b) << 10))
+
+extern u16 nds_vram_main_bg[];
+extern u16 nds_palette_main_bg[];
+extern vu16 nds_registers[];
+
+#define BG_GFX (nds_vram_main_bg)
+#define BG_TILE_RAM(base) (nds_vram_main_bg + ((base) << 13))
+#define BG_PALETTE (nds_palette_main_bg)
+
+#define REG_BG0CNT (nds_registers[0])
+#define REG_BG1CNT (nds_registers[1])
+#define REG_BG0HOFS (nds_registers[2])
+#define REG_BG0VOFS (nds_registers[3])
+#define REG_BG1HOFS (nds_registers[4])
+#define REG_BG1VOFS (nds_registers[5])
+#define REG_KEYCNT (nds_registers[6])
+
+void powerOn(int bits);
+void videoSetMode(u32 mode);
+void videoSetModeSub(u32 mode);
+void vramSetBankA(int mode);
+void vramSetBankC(int mode);
+void lcdSwap(void);
+void dmaFillWords(u32 value, void *dest, u32 size);
+void dmaCopyWords(u8 channel, const void *src, void *dest, u32 size);
+void swiWaitForVBlank(void);
+
+/* interrupts */
+
+#define IRQ_VBLANK (1 << 0)
+#define IRQ_KEYS (1 << 12)
+
+void irqEnable(u32 irq);
+void irqDisable(u32 irq);
+void swiIntrWait(u32 waitForSet, u32 flags);
+
+/* timers */
+
+#define TIMER_ENABLE (1 << 7)
+#define TIMER_CASCADE (1 << 2)
+#define TIMER_DIV_1 0
+
+vu16 *nds_timer_data(int timer);
+vu16 *nds_timer_cr(int timer);
+
+#define TIMER_DATA(n) (*nds_timer_data(n))
+#define TIMER_CR(n) (*nds_timer_cr(n))
+#define TIMER0_DATA TIMER_DATA(0)
+#define TIMER1_DATA TIMER_DATA(1)
+#define TIMER0_CR TIMER_CR(0)
+#define TIMER1_CR TIMER_CR(1)
+
+typedef void (*VoidFn)(void);
+typedef enum {
+	ClockDivider_1 = 0,
+	ClockDivider_64 = 1,
+	ClockDivider_256 = 2,
+	ClockDivider_1024 = 3
+} ClockDivider;
+
+#define BUS_CLOCK 33513982
+#define TIMER_FREQ(n) (-BUS_CLOCK / (n))
+#define TIMER_FREQ_64(n) (-(BUS_CLOCK >> 6) / (n))
+#define TIMER_FREQ_256(n) (-(BUS_CLOCK >> 8) / (n))
+#define TIMER_FREQ_1024(n) (-(BUS_CLOCK >> 10) / (n))
+
+void timerStart(int timer, ClockDivider divider, u16 ticks, VoidFn callback);
+
+/* input */
+
+#define KEY_A (1 << 0)
+#define KEY_B (1 << 1)
+#define KEY_SELECT (1 << 2)
+#define KEY_START (1 << 3)
+#define KEY_RIGHT (1 << 4)
+#define KEY_LEFT (1 << 5)
+#define KEY_UP (1 << 6)
+#define KEY_DOWN (1 << 7)
+#define KEY_R (1 << 8)
+#define KEY_L (1 << 9)
+#define KEY_X (1 << 10)
+#define KEY_Y (1 << 11)
+#define KEY_TOUCH (1 << 12)
+#define KEY_LID (1 << 13)
+
+typedef struct touchPosition {
+	u16 rawx, rawy, px, py, z1, z2;
+} touchPosition;
+
+void scanKeys(void);
+u32 keysDown(void);
+u32 keysHeld(void);
+void touchRead(touchPosition *data);
+
+/* keyboard */
+
+#define DVK_FOLD -23
+#define DVK_ENTER 10
+#define DVK_UP -17
+#define DVK_RIGHT -18
+#define DVK_DOWN -19
+#define DVK_LEFT -20
+
+typedef struct Keyboard {
+	int scrollSpeed;
+} Keyboard;
+
+Keyboard *keyboardDemoInit(void);
+Keyboard *keyboardGetDefault(void);
+void keyboardShow(void);
+void keyboardHide(void);
+int keyboardUpdate(void);
+
+/* console */
+
+typedef struct PrintConsole {
+	int windowX, windowY, windowWidth, windowHeight;
+} PrintConsole;
+
+PrintConsole *consoleDemoInit(void);
+PrintConsole *consoleSelect(PrintConsole *console);
+void consoleSetWindow(PrintConsole *console, int x, int y, int width, int height);
+
+/* fifo */
+
+#define FIFO_USER_01 0
+
+bool fifoSendValue32(int channel, u32 value);
+
+#endif
@@ -0,0 +1,31 @@
+#include <nds.h>
+
+/* Bus clock the DS timers count at with TIMER_DIV_1. */
+#define HOST_TIMER_FREQUENCY 33513982
+
+typedef struct {
+	u32 held;
+	int key;
+	bool touching;
+	u16 touchx, touchy;
+} HostInput;
+
+/* runner */
+void host_input(HostInput *in);
+void host_vblank(void);
+
+/* emulator.c: jumps a vector may take per frame, 0 for no limit */
+extern u32 vector_budget;
+/* emulator.c: frame pacing, frames overrun, screen vectors dropped and
+   frames left idle */
+extern bool frame_pacing;
+extern u32 frames_missed, frames_skipped, frames_idle;
+
+/* x86-64 translator, in place of evaluxn */
+struct Uxn;
+int jit_init(void);
+void jit_flush(void);
+int jit_evaluxn(struct Uxn *u, u16 vec);
+
+/* libnds shim */
+u64 host_nanoseconds(void);
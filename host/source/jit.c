@@ -0,0 +1,786 @@
+#include <stddef.h>
+#include <sys/mman.h>
+#include "../../include/uxn.h"
+#include "host.h"
+
+/*
+x86-64 translator for the host build, selected with --jit. Code is
+compiled a basic block at a time, on first use, into functions that work on
+the Uxn struct directly:
+
+  rbx  the Uxn             r12  ram.dat
+  r13  wst.ptr             r15  ram.fuse
+  r14  rst.ptr             rbp  the watch map of compiled opcode bytes
+
+Stack slots are addressed off the pointer registers with the adjustments of
+the block so far folded into the displacement; the registers are only
+updated where the block is left, or before a device is called so that it
+sees the same Uxn state as under runuxn. Blocks end after a jump, DEO or
+BRK and leave the next pc in eax for a dispatch stub, which chains straight
+into the next block when it is compiled already.
+
+DEI and DEO go through the device handlers exactly as the interpreter
+does. Stores test the fuse and watch maps of their address and call
+fuseuxn when either is set, which the interpreter would have to see as
+well; a store into compiled code drops the whole cache and leaves the
+block. Entry points that have been recompiled too often run in the
+interpreter for the rest of the vector instead.
+*/
+
+#if defined(__x86_64__) && !defined(CPU_ERROR_CHECKING)
+
+#define JIT_CODE_SIZE (16 << 20)
+#define JIT_BLOCK_ROOM (64 << 10)
+#define JIT_BLOCK_OPS 128
+#define JIT_RETRIES 8
+
+enum { RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI, R8, R9, R10, R11, R12, R13, R14, R15 };
+
+/* instruction flags for rr() and rm() */
+#define W 0x01 /* REX.W */
+#define P16 0x02 /* operand size prefix */
+#define B8 0x04 /* byte register operand */
+#define S8 0x08 /* index scaled by 8 */
+
+enum { CC_B = 0x2, CC_E = 0x4, CC_NE = 0x5, CC_A = 0x7 };
+
+#define OFF(f) ((int)offsetof(Uxn, f))
+
+typedef u32 (*JitEnter)(Uxn *u, Uint8 *code);
+
+typedef struct {
+	int reg, dat, err;   /* pointer register, offsets of dat[] and error */
+	int delta;           /* adjustment the pointer register is behind by */
+	int pop, push, keep; /* slot cursors of the instruction being compiled */
+} JitStack;
+
+static Uint8 *code_base, *code_start, *code_ptr, *dispatch;
+static JitEnter enter;
+static Uxn *jit_uxn;
+static int flush_pending;
+
+static Uint8 *entry[65536];
+static Uint8 watch[65536], retries[65536];
+static Uint16 owner[65536];
+
+#pragma mark - Encoding
+
+static void
+b8(int x)
+{
+	*code_ptr++ = x;
+}
+
+static void
+b16(Uint16 x)
+{
+	memcpy(code_ptr, &x, 2);
+	code_ptr += 2;
+}
+
+static void
+b32(u32 x)
+{
+	memcpy(code_ptr, &x, 4);
+	code_ptr += 4;
+}
+
+static void
+b64(u64 x)
+{
+	memcpy(code_ptr, &x, 8);
+	code_ptr += 8;
+}
+
+static void
+prefix(int flags, int op, int reg, int index, int base)
+{
+	int r = (flags & W ? 8 : 0) | (reg & 8 ? 4 : 0) | (index & 8 ? 2 : 0) | (base & 8 ? 1 : 0);
+	if(flags & P16)
+		b8(0x66);
+	if(r || (flags & B8 && ((reg >= RSP && reg <= RDI) || (base >= RSP && base <= RDI))))
+		b8(0x40 | r);
+	if(op > 0xff)
+		b8(op >> 8);
+	b8(op);
+}
+
+/* op reg, rm - register direct; reg doubles as the opcode extension */
+static void
+rr(int flags, int op, int reg, int rm)
+{
+	prefix(flags, op, reg, 0, rm);
+	b8(0xc0 | (reg & 7) << 3 | (rm & 7));
+}
+
+/* op reg, [base + index + disp]; no index when index < 0 */
+static void
+rm(int flags, int op, int reg, int base, int index, s32 disp)
+{
+	int mod = disp >= -128 && disp < 128 ? 0x40 : 0x80;
+	prefix(flags, op, reg, index < 0 ? 0 : index, base);
+	if(index < 0 && (base & 7) != RSP)
+		b8(mod | (reg & 7) << 3 | (base & 7));
+	else {
+		b8(mod | (reg & 7) << 3 | RSP);
+		b8((flags & S8 ? 0xc0 : 0) | ((index < 0 ? RSP : index) & 7) << 3 | (base & 7));
+	}
+	if(mod == 0x40)
+		b8(disp);
+	else
+		b32(disp);
+}
+
+static void
+movi(int reg, u32 x)
+{
+	if(reg & 8)
+		b8(0x41);
+	b8(0xb8 | (reg & 7));
+	b32(x);
+}
+
+static void
+movi64(int reg, u64 x)
+{
+	b8(reg & 8 ? 0x49 : 0x48);
+	b8(0xb8 | (reg & 7));
+	b64(x);
+}
+
+static void
+call(void *fn)
+{
+	rr(W, 0x89, RBX, RDI);
+	movi64(RAX, (u64)fn);
+	rr(0, 0xff, 2, RAX);
+}
+
+static void
+jmp(Uint8 *target)
+{
+	b8(0xe9);
+	b32(target - (code_ptr + 4));
+}
+
+/* forward conditional jump, resolved by land() */
+static Uint8 *
+jcc(int cc)
+{
+	b8(0x0f);
+	b8(0x80 | cc);
+	b32(0);
+	return code_ptr;
+}
+
+static void
+land(Uint8 *from)
+{
+	s32 d = code_ptr - from;
+	memcpy(from - 4, &d, 4);
+}
+
+#pragma mark - Stacks
+
+static void
+slot(JitStack *s, int flags, int op, int reg, int k)
+{
+	rm(flags, op, reg, RBX, s->reg, s->dat + s->delta + k);
+}
+
+static void
+start(JitStack *s, int keep)
+{
+	s->pop = s->push = 0;
+	s->keep = keep;
+}
+
+/* Pops load into reg; with reg < 0 the slot is only skipped. Shorts are byte
+   swapped into value order unless raw, for code that merely moves them. */
+static void
+pop8(JitStack *s, int reg)
+{
+	s->pop--;
+	if(!s->keep)
+		s->push = s->pop;
+	if(reg >= 0)
+		slot(s, 0, 0x0fb6, reg, s->pop);
+}
+
+static void
+pop16(JitStack *s, int reg, int raw)
+{
+	s->pop -= 2;
+	if(!s->keep)
+		s->push = s->pop;
+	if(reg >= 0) {
+		slot(s, 0, 0x0fb7, reg, s->pop);
+		if(!raw) {
+			rr(P16, 0xc1, 0, reg);
+			b8(8);
+		}
+	}
+}
+
+static void
+push8(JitStack *s, int reg)
+{
+	slot(s, B8, 0x88, reg, s->push++);
+}
+
+static void
+push16(JitStack *s, int reg, int raw)
+{
+	if(!raw) {
+		rr(0, 0x89, reg, R11);
+		rr(P16, 0xc1, 0, R11);
+		b8(8);
+		reg = R11;
+	}
+	slot(s, P16, 0x89, reg, s->push);
+	s->push += 2;
+}
+
+static void
+push16i(JitStack *s, Uint16 x)
+{
+	slot(s, P16, 0xc7, 0, s->push);
+	b16(x >> 8 | x << 8);
+	s->push += 2;
+}
+
+static void
+finish(JitStack *s)
+{
+	s->delta += s->push;
+	s->pop = s->push = 0;
+}
+
+static void
+adjust(JitStack *s)
+{
+	if(s->delta & 0xff) {
+		rr(B8, 0x80, 0, s->reg);
+		b8(s->delta);
+	}
+}
+
+/* Brings the pointer registers and the Uxn struct up to date, as SYNC does. */
+static void
+sync_stacks(JitStack *w, JitStack *r, Uint16 pc)
+{
+	adjust(w);
+	adjust(r);
+	w->delta = r->delta = 0;
+	rm(P16, 0xc7, 0, RBX, -1, OFF(ram.ptr));
+	b16(pc);
+	rm(B8, 0x88, R13, RBX, -1, OFF(wst.ptr));
+	rm(B8, 0x88, R14, RBX, -1, OFF(rst.ptr));
+}
+
+/* Leaves the block with the next pc or exit status in eax, after n
+   instructions. The stacks keep their adjustments for the code that follows
+   on other paths. */
+static void
+leave(JitStack *w, JitStack *r, int n)
+{
+	adjust(w);
+	adjust(r);
+	movi64(RDX, (u64)&uxn_instructions);
+	rm(W, 0x81, 0, RDX, -1, 0);
+	b32(n);
+	jmp(dispatch);
+}
+
+static void
+leave_at(JitStack *w, JitStack *r, int n, u32 pc)
+{
+	movi(RAX, pc);
+	leave(w, r, n);
+}
+
+#pragma mark - Helpers
+
+static Uint8
+jit_dei(Uxn *u, Uint8 a)
+{
+	Device *d = &u->dev[a >> 4];
+	if(d->rhook >> (a & 0xf) & 1)
+		d->talk(d, a & 0x0f, 0);
+	return d->dat[a & 0xf];
+}
+
+static Uint16
+jit_dei2(Uxn *u, Uint8 a)
+{
+	Device *d = &u->dev[a >> 4];
+	Uint8 hi;
+	if(d->talk16 && ((u32)d->rhook | (u32)d->rhook << 16) >> (a & 0xf) & 3) {
+		d->talk16(d, a & 0x0f, 0);
+		return d->dat[a & 0xf] << 8 | d->dat[(a + 1) & 0xf];
+	}
+	if(d->rhook >> (a & 0xf) & 1)
+		d->talk(d, a & 0x0f, 0);
+	hi = d->dat[a & 0xf];
+	if(d->rhook >> ((a + 1) & 0xf) & 1)
+		d->talk(d, (a + 1) & 0x0f, 0);
+	return hi << 8 | d->dat[(a + 1) & 0xf];
+}
+
+static int
+jit_deo(Uxn *u, Uint8 a, Uint8 b)
+{
+	Device *d = &u->dev[a >> 4];
+	d->dat[a & 0xf] = b;
+	return !(d->whook >> (a & 0xf) & 1) || d->talk(d, a & 0x0f, 1);
+}
+
+static int
+jit_deo2(Uxn *u, Uint8 a, Uint16 b)
+{
+	Device *d = &u->dev[a >> 4];
+	d->dat[a & 0xf] = b >> 8;
+	if(d->talk16 && ((u32)d->whook | (u32)d->whook << 16) >> (a & 0xf) & 3) {
+		d->dat[(a + 1) & 0xf] = b;
+		return d->talk16(d, a & 0x0f, 1);
+	}
+	if(d->whook >> (a & 0xf) & 1 && !d->talk(d, a & 0x0f, 1))
+		return 0;
+	d->dat[(a + 1) & 0xf] = b;
+	return !(d->whook >> ((a + 1) & 0xf) & 1) || d->talk(d, (a + 1) & 0x0f, 1);
+}
+
+/* A store hit a superinstruction or compiled code: rescan the bytes as if
+   they had been loaded, and tell the block whether it has to stop. */
+static int
+jit_stored(Uxn *u, Uint16 a, int length)
+{
+	fuseuxn(u, a, length);
+	if(a + length > 0x10000)
+		fuseuxn(u, 0, a + length - 0x10000);
+	return flush_pending;
+}
+
+static void
+jit_loaded(Uxn *u, Uint16 addr, Uint16 length)
+{
+	int a;
+	for(a = addr; a < addr + length; a++)
+		if(watch[a]) {
+			if(retries[owner[a]] <= JIT_RETRIES)
+				retries[owner[a]]++;
+			flush_pending = 1;
+			/* Blocks chain through the entry table: empty it now, so
+			   that nothing runs into a stale block before the flush. */
+			memset(entry, 0, sizeof(entry));
+			return;
+		}
+}
+
+#pragma mark - Compiler
+
+/* Stores the byte in cl, or the short in cx with wide, to the address in eax;
+   edx is left holding the address of the second byte. */
+static void
+store(int wide, int wraps)
+{
+	if(!wide) {
+		rm(B8, 0x88, RCX, R12, RAX, 0);
+		return;
+	}
+	rr(0, 0x89, RAX, RDX);
+	rr(0, 0x83, 0, RDX);
+	b8(1);
+	if(wraps)
+		rr(0, 0x0fb7, RDX, RDX);
+	rm(B8, 0x88, RCX, R12, RDX, 0);
+	rr(0, 0xc1, 5, RCX);
+	b8(8);
+	rm(B8, 0x88, RCX, R12, RAX, 0);
+}
+
+static void
+check_store(JitStack *w, JitStack *r, int n, Uint16 pc, int wide)
+{
+	Uint8 *fast, *stay;
+	rm(0, 0x0fb6, R11, R15, RAX, 0);
+	rm(B8, 0x0a, R11, RBP, RAX, 0);
+	if(wide) {
+		rm(B8, 0x0a, R11, R15, RDX, 0);
+		rm(B8, 0x0a, R11, RBP, RDX, 0);
+	}
+	fast = jcc(CC_E);
+	rr(0, 0x89, RAX, RSI);
+	movi(RDX, wide ? 2 : 1);
+	call(jit_stored);
+	rr(0, 0x85, RAX, RAX);
+	stay = jcc(CC_E);
+	leave_at(w, r, n, pc);
+	land(fast);
+	land(stay);
+}
+
+/* eax = pc + (Sint8)al */
+static void
+relative(Uint16 pc)
+{
+	rr(B8, 0x0fbe, RAX, RAX);
+	rr(0, 0x81, 0, RAX);
+	b32(pc);
+	rr(0, 0x0fb7, RAX, RAX);
+}
+
+static int
+compile(Uxn *u, Uint16 addr)
+{
+	static const int compares[] = {CC_E, CC_NE, CC_A, CC_B}; /* EQU NEQ GTH LTH */
+	JitStack w = {R13, OFF(wst.dat), OFF(wst.error)}, r = {R14, OFF(rst.dat), OFF(rst.error)};
+	Uint8 *ram = u->ram.dat;
+	Uint16 pc = addr;
+	int n = 0;
+	if(retries[addr] > JIT_RETRIES)
+		return 0;
+	if(code_ptr + JIT_BLOCK_ROOM > code_base + JIT_CODE_SIZE)
+		jit_flush();
+	entry[addr] = code_ptr;
+	for(;;) {
+		Uint8 instr = ram[pc], wide = instr & 0x20;
+		JitStack *src = instr & 0x40 ? &r : &w, *dst = instr & 0x40 ? &w : &r;
+		watch[pc] = 1;
+		owner[pc] = addr;
+		pc++;
+		n++;
+		start(src, instr & 0x80);
+		start(dst, 0);
+		if(!instr) {
+			rm(P16, 0xc7, 0, RBX, -1, OFF(ram.ptr));
+			b16(pc);
+			leave_at(&w, &r, n, 0x10000);
+			return 1;
+		}
+		switch(instr & 0x1f) {
+		case 0x00: /* LIT */
+			if(!wide) {
+				rm(0, 0x0fb6, RAX, R12, -1, pc++);
+				push8(src, RAX);
+			} else if(pc != 0xffff) {
+				rm(0, 0x0fb7, RAX, R12, -1, pc);
+				push16(src, RAX, 1);
+				pc += 2;
+			} else {
+				rm(0, 0x0fb6, RAX, R12, -1, pc++);
+				push8(src, RAX);
+				rm(0, 0x0fb6, RAX, R12, -1, pc++);
+				push8(src, RAX);
+			}
+			break;
+		case 0x01: /* INC */
+			if(!wide) pop8(src, RAX); else pop16(src, RAX, 0);
+			rr(0, 0x83, 0, RAX);
+			b8(1);
+			if(!wide) push8(src, RAX); else push16(src, RAX, 0);
+			break;
+		case 0x02: /* POP */
+			if(!wide) pop8(src, -1); else pop16(src, -1, 1);
+			break;
+		case 0x03: /* DUP */
+			if(!wide) pop8(src, RAX); else pop16(src, RAX, 1);
+			if(!wide) push8(src, RAX), push8(src, RAX);
+			else push16(src, RAX, 1), push16(src, RAX, 1);
+			break;
+		case 0x04: /* NIP */
+			if(!wide) pop8(src, RAX), pop8(src, -1), push8(src, RAX);
+			else pop16(src, RAX, 1), pop16(src, -1, 1), push16(src, RAX, 1);
+			break;
+		case 0x05: /* SWP */
+			if(!wide) pop8(src, RAX), pop8(src, RCX), push8(src, RAX), push8(src, RCX);
+			else pop16(src, RAX, 1), pop16(src, RCX, 1), push16(src, RAX, 1), push16(src, RCX, 1);
+			break;
+		case 0x06: /* OVR */
+			if(!wide) pop8(src, RAX), pop8(src, RCX), push8(src, RCX), push8(src, RAX), push8(src, RCX);
+			else pop16(src, RAX, 1), pop16(src, RCX, 1), push16(src, RCX, 1), push16(src, RAX, 1), push16(src, RCX, 1);
+			break;
+		case 0x07: /* ROT */
+			if(!wide) {
+				pop8(src, RAX), pop8(src, RCX), pop8(src, RDX);
+				push8(src, RCX), push8(src, RAX), push8(src, RDX);
+			} else {
+				pop16(src, RAX, 1), pop16(src, RCX, 1), pop16(src, RDX, 1);
+				push16(src, RCX, 1), push16(src, RAX, 1), push16(src, RDX, 1);
+			}
+			break;
+		case 0x08: /* EQU */
+		case 0x09: /* NEQ */
+		case 0x0a: /* GTH */
+		case 0x0b: /* LTH */
+			if(!wide) pop8(src, RAX), pop8(src, RCX);
+			else pop16(src, RAX, 0), pop16(src, RCX, 0);
+			rr(0, 0x39, RAX, RCX);
+			rr(B8, 0x0f90 | compares[instr & 0x3], 0, RAX);
+			push8(src, RAX);
+			break;
+		case 0x0c: /* JMP */
+			if(!wide) pop8(src, RAX), relative(pc);
+			else pop16(src, RAX, 0);
+			finish(src);
+			leave(&w, &r, n);
+			return 1;
+		case 0x0d: /* JCN */
+			if(!wide) pop8(src, RAX), pop8(src, RCX), relative(pc);
+			else pop16(src, RAX, 0), pop8(src, RCX);
+			movi(RDX, pc);
+			rr(B8, 0x84, RCX, RCX);
+			rr(0, 0x0f44, RAX, RDX);
+			finish(src);
+			leave(&w, &r, n);
+			return 1;
+		case 0x0e: /* JSR */
+			if(!wide) pop8(src, RAX), relative(pc);
+			else pop16(src, RAX, 0);
+			push16i(dst, pc);
+			finish(src);
+			finish(dst);
+			leave(&w, &r, n);
+			return 1;
+		case 0x0f: /* STH */
+			if(!wide) pop8(src, RAX), push8(dst, RAX);
+			else pop16(src, RAX, 1), push16(dst, RAX, 1);
+			break;
+		case 0x10: /* LDZ */
+			pop8(src, RAX);
+			if(!wide) {
+				rm(0, 0x0fb6, RAX, R12, RAX, 0);
+				push8(src, RAX);
+			} else {
+				rm(0, 0x0fb7, RAX, R12, RAX, 0);
+				push16(src, RAX, 1);
+			}
+			break;
+		case 0x11: /* STZ */
+		case 0x13: /* STR */
+		case 0x15: /* STA */
+			if((instr & 0x1f) == 0x15)
+				pop16(src, RAX, 0);
+			else
+				pop8(src, RAX);
+			if(!wide) pop8(src, RCX); else pop16(src, RCX, 0);
+			if((instr & 0x1f) == 0x13)
+				relative(pc);
+			store(wide, (instr & 0x1f) != 0x11);
+			finish(src);
+			check_store(&w, &r, n, pc, wide);
+			break;
+		case 0x12: /* LDR */
+		case 0x14: /* LDA */
+			if((instr & 0x1f) == 0x12)
+				pop8(src, RAX), relative(pc);
+			else
+				pop16(src, RAX, 0);
+			if(!wide) {
+				rm(0, 0x0fb6, RAX, R12, RAX, 0);
+				push8(src, RAX);
+			} else {
+				rr(0, 0x89, RAX, RDX);
+				rr(0, 0x83, 0, RDX);
+				b8(1);
+				rr(0, 0x0fb7, RDX, RDX);
+				rm(0, 0x0fb6, RAX, R12, RAX, 0);
+				rm(0, 0x0fb6, RDX, R12, RDX, 0);
+				push8(src, RAX);
+				push8(src, RDX);
+			}
+			break;
+		case 0x16: /* DEI */
+			sync_stacks(&w, &r, pc);
+			pop8(src, RSI);
+			call(wide ? (void *)jit_dei2 : (void *)jit_dei);
+			if(!wide) push8(src, RAX); else push16(src, RAX, 0);
+			break;
+		case 0x17: { /* DEO */
+			Uint8 *ok;
+			sync_stacks(&w, &r, pc);
+			pop8(src, RSI);
+			if(!wide) pop8(src, RDX); else pop16(src, RDX, 0);
+			call(wide ? (void *)jit_deo2 : (void *)jit_deo);
+			rr(0, 0x85, RAX, RAX);
+			ok = jcc(CC_NE);
+			leave_at(&w, &r, n, 0x10000);
+			land(ok);
+			finish(src);
+			leave_at(&w, &r, n, pc);
+			return 1;
+		}
+		case 0x18: /* ADD */
+		case 0x19: /* SUB */
+		case 0x1a: /* MUL */
+		case 0x1c: /* AND */
+		case 0x1d: /* ORA */
+		case 0x1e: /* EOR */
+			if(!wide) pop8(src, RAX), pop8(src, RCX);
+			else pop16(src, RAX, 0), pop16(src, RCX, 0);
+			switch(instr & 0x1f) {
+			case 0x18: rr(0, 0x01, RAX, RCX); break;
+			case 0x19: rr(0, 0x29, RAX, RCX); break;
+			case 0x1a: rr(0, 0x0faf, RCX, RAX); break;
+			case 0x1c: rr(0, 0x21, RAX, RCX); break;
+			case 0x1d: rr(0, 0x09, RAX, RCX); break;
+			case 0x1e: rr(0, 0x31, RAX, RCX); break;
+			}
+			if(!wide) push8(src, RCX); else push16(src, RCX, 0);
+			break;
+		case 0x1b: { /* DIV */
+			Uint8 *nonzero;
+			if(!wide) pop8(src, RAX), pop8(src, RCX);
+			else pop16(src, RAX, 0), pop16(src, RCX, 0);
+			rr(0, 0x85, RAX, RAX);
+			nonzero = jcc(CC_NE);
+			rm(0, 0xc6, 0, RBX, -1, src->err);
+			b8(3);
+			movi(RAX, 1);
+			land(nonzero);
+			rr(0, 0x89, RAX, R11);
+			rr(0, 0x89, RCX, RAX);
+			rr(0, 0x31, RDX, RDX);
+			rr(0, 0xf7, 6, R11);
+			if(!wide) push8(src, RAX); else push16(src, RAX, 0);
+			break;
+		}
+		case 0x1f: /* SFT */
+			pop8(src, RAX);
+			if(!wide) pop8(src, RDX); else pop16(src, RDX, 0);
+			rr(0, 0x89, RAX, RCX);
+			rr(0, 0x83, 4, RCX);
+			b8(wide ? 0x0f : 0x07);
+			rr(0, 0xd3, 5, RDX);
+			rr(0, 0x89, RAX, RCX);
+			rr(0, 0xc1, 5, RCX);
+			b8(4);
+			rr(0, 0x83, 4, RCX);
+			b8(wide ? 0x0f : 0x07);
+			rr(0, 0xd3, 4, RDX);
+			if(!wide) push8(src, RDX); else push16(src, RDX, 0);
+			break;
+		}
+		finish(src);
+		finish(dst);
+		if(n == JIT_BLOCK_OPS) {
+			leave_at(&w, &r, n, pc);
+			return 1;
+		}
+	}
+}
+
+/* Emits the entry and dispatch stubs at the start of the code buffer. */
+static void
+stubs(void)
+{
+	static const int saved[] = {RBX, RBP, R12, R13, R14, R15};
+	Uint8 *status, *missing;
+	int i;
+	code_ptr = code_base;
+	enter = (JitEnter)code_ptr;
+	for(i = 0; i < 6; i++)
+		prefix(0, 0x50 | (saved[i] & 7), 0, 0, saved[i]);
+	rr(W, 0x83, 5, RSP);
+	b8(8);
+	rr(W, 0x89, RDI, RBX);
+	rm(W, 0x8b, R12, RBX, -1, OFF(ram.dat));
+	rm(W, 0x8b, R15, RBX, -1, OFF(ram.fuse));
+	movi64(RBP, (u64)watch);
+	rm(0, 0x0fb6, R13, RBX, -1, OFF(wst.ptr));
+	rm(0, 0x0fb6, R14, RBX, -1, OFF(rst.ptr));
+	rr(0, 0xff, 4, RSI);
+	dispatch = code_ptr;
+	rr(0, 0x81, 7, RAX);
+	b32(0xffff);
+	status = jcc(CC_A);
+	movi64(RCX, (u64)entry);
+	rm(W | S8, 0x8b, RCX, RCX, RAX, 0);
+	rr(W, 0x85, RCX, RCX);
+	missing = jcc(CC_E);
+	rr(0, 0xff, 4, RCX);
+	land(status);
+	land(missing);
+	rm(B8, 0x88, R13, RBX, -1, OFF(wst.ptr));
+	rm(B8, 0x88, R14, RBX, -1, OFF(rst.ptr));
+	rr(W, 0x83, 0, RSP);
+	b8(8);
+	for(i = 5; i >= 0; i--)
+		prefix(0, 0x58 | (saved[i] & 7), 0, 0, saved[i]);
+	b8(0xc3);
+	code_start = code_ptr;
+}
+
+#pragma mark - Interface
+
+int
+jit_init(void)
+{
+	code_base = mmap(NULL, JIT_CODE_SIZE, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if(code_base == MAP_FAILED) {
+		perror("jit");
+		return 0;
+	}
+	stubs();
+	uxn_load_hook = jit_loaded;
+	return 1;
+}
+
+void
+jit_flush(void)
+{
+	memset(entry, 0, sizeof(entry));
+	memset(watch, 0, sizeof(watch));
+	code_ptr = code_start;
+	flush_pending = 0;
+}
+
+int
+jit_evaluxn(Uxn *u, Uint16 vec)
+{
+	u32 pc = vec;
+	if(!vec || u->dev[0].dat[0xf])
+		return 0;
+	if(u->wst.ptr > 0xf8) u->wst.ptr = 0xf8;
+	if(u != jit_uxn) {
+		jit_flush();
+		memset(retries, 0, sizeof(retries));
+		jit_uxn = u;
+	}
+	for(;;) {
+		if(flush_pending)
+			jit_flush();
+		if(!entry[pc] && !compile(u, pc)) {
+			/* The interpreter's stores are not watched: whatever it
+			   leaves in memory has to be compiled afresh. */
+			int ret = runuxn(u, pc);
+			jit_flush();
+			return ret;
+		}
+		pc = enter(u, entry[pc]);
+		if(pc > 0xffff)
+			return 1;
+	}
+}
+
+#else
+
+int
+jit_init(void)
+{
+	fprintf(stderr, "jit: only available in release builds for x86-64\n");
+	return 0;
+}
+
+void
+jit_flush(void)
+{
+}
+
+int
+jit_evaluxn(Uxn *u, Uint16 vec)
+{
+	return evaluxn(u, vec);
+}
+
+#endif
@@ -0,0 +1,303 @@
+#include <ctype.h>
+#include <getopt.h>
+#include <limits.h>
+#include "../../include/uxn.h"
+#include "../../arm9/source/ppu.h"
+#include "host.h"
+
+/*
+Headless benchmark runner: boots emulator.c's main() against the libnds
+shim, feeds it scripted input and stops after a fixed number of frames.
+
+Input scripts hold one event per line, applied at the start of the given
+frame; '#' starts a comment:
+
+  <frame> press <key>...     hold A B SELECT START RIGHT LEFT UP DOWN R L X Y
+  <frame> release <key>...
+  <frame> key <char|code>    type one character on the software keyboard
+  <frame> touch <x> <y>      touch (or drag to) a point on the touchscreen
+  <frame> untouch
+*/
+
+int uxnds_main(int argc, char **argv);
+
+typedef struct {
+	Uint32 frame;
+	char cmd;
+	Uint32 arg0;
+	Uint16 arg1, arg2;
+} HostEvent;
+
+static const char *key_names[] = {
+	"A", "B", "SELECT", "START", "RIGHT", "LEFT", "UP", "DOWN", "R", "L", "X", "Y"};
+
+static HostEvent *events;
+static Uint32 events_count, events_pos;
+static HostInput state = {0, -1, false, 0, 0};
+
+static Uint32 frame, frames = 600;
+static u64 *frame_ns;
+static u64 time_start, time_last;
+
+static Uxn *uxn;
+static char rompath[PATH_MAX];
+static int use_jit;
+static u32 budget;
+
+static int
+usage(const char *name)
+{
+	fprintf(stderr, "usage: %s [-f frames] [-i input] [--jit | --budget jumps] [--pacing] rom\n", name);
+	return 1;
+}
+
+/* emulator.c is built to call this in place of evaluxn. */
+int
+host_evaluxn(Uxn *u, Uint16 vec)
+{
+	uxn = u;
+	return use_jit ? jit_evaluxn(u, vec) : evaluxn(u, vec);
+}
+
+/* ... and this in place of loaduxn, to boot the ROM given to the runner
+   rather than boot.rom. */
+int
+host_loaduxn(Uxn *u, char *filepath)
+{
+	return loaduxn(u, rompath);
+}
+
+static Uint32
+parse_keys(char *s, const char *path, int line)
+{
+	Uint32 keys = 0, i;
+	char *tok;
+	for(tok = strtok(s, " \t\r\n"); tok; tok = strtok(NULL, " \t\r\n")) {
+		for(i = 0; i < sizeof(key_names) / sizeof(*key_names); i++)
+			if(!strcasecmp(tok, key_names[i]))
+				break;
+		if(i == sizeof(key_names) / sizeof(*key_names)) {
+			fprintf(stderr, "%s:%d: unknown key '%s'\n", path, line, tok);
+			exit(1);
+		}
+		keys |= 1 << i;
+	}
+	return keys;
+}
+
+static int
+load_script(const char *path)
+{
+	char buf[256], cmd[16];
+	int line = 0, n, x, y;
+	FILE *f;
+	if(!(f = fopen(path, "r"))) {
+		perror(path);
+		return 0;
+	}
+	while(fgets(buf, sizeof(buf), f)) {
+		HostEvent ev = {0};
+		char *p = strchr(buf, '#');
+		line++;
+		if(p) *p = 0;
+		if(sscanf(buf, "%u %15s %n", &ev.frame, cmd, &n) < 2)
+			continue;
+		ev.cmd = cmd[0];
+		if(!strcmp(cmd, "press") || !strcmp(cmd, "release"))
+			ev.arg0 = parse_keys(buf + n, path, line);
+		else if(!strcmp(cmd, "key"))
+			ev.arg0 = (isdigit((unsigned char)buf[n]) && buf[n + 1] && !isspace((unsigned char)buf[n + 1])) ? strtoul(buf + n, NULL, 0) : buf[n];
+		else if(!strcmp(cmd, "touch") && sscanf(buf + n, "%d %d", &x, &y) == 2)
+			ev.arg1 = x, ev.arg2 = y;
+		else if(strcmp(cmd, "untouch")) {
+			fprintf(stderr, "%s:%d: bad event '%s'\n", path, line, cmd);
+			exit(1);
+		}
+		if(events_count && ev.frame < events[events_count - 1].frame) {
+			fprintf(stderr, "%s:%d: events must be in frame order\n", path, line);
+			exit(1);
+		}
+		events = realloc(events, sizeof(HostEvent) * (events_count + 1));
+		events[events_count++] = ev;
+	}
+	fclose(f);
+	return 1;
+}
+
+void
+host_input(HostInput *in)
+{
+	state.key = -1;
+	for(; events_pos < events_count && events[events_pos].frame <= frame; events_pos++) {
+		HostEvent *ev = &events[events_pos];
+		switch(ev->cmd) {
+		case 'p': state.held |= ev->arg0; break;
+		case 'r': state.held &= ~ev->arg0; break;
+		case 'k': state.key = ev->arg0; break;
+		case 't': state.touching = true; state.touchx = ev->arg1; state.touchy = ev->arg2; break;
+		case 'u': state.touching = false; break;
+		}
+	}
+	*in = state;
+}
+
+static int
+cmp_u64(const void *a, const void *b)
+{
+	u64 x = *(const u64 *)a, y = *(const u64 *)b;
+	return (x > y) - (x < y);
+}
+
+static double
+percentile(u64 *sorted, Uint32 count, int p)
+{
+	return sorted[(count - 1) * p / 100] / 1000.0;
+}
+
+static Uint32
+hash_displayed(void)
+{
+	/* FNV-1a over the displayed tile bases and the palette, so that runs of
+	   two builds can be checked for identical output. */
+	Uint32 h = 2166136261u, i;
+	Uint8 *vram = (Uint8 *)BG_TILE_RAM(0), *pal = (Uint8 *)BG_PALETTE;
+	for(i = 0; i < 0x8000 * 2; i++)
+		h = (h ^ vram[i]) * 16777619u;
+	for(i = 0; i < 16 * 2; i++)
+		h = (h ^ pal[i]) * 16777619u;
+	return h;
+}
+
+static Uint32
+hash_picture(void)
+{
+	/* The same over the colors shown, pixel by pixel, which stay the same
+	   whichever way the layers are laid out in VRAM (PACKED=true). */
+	Uint32 h = 2166136261u, x, y, pixel;
+	Uint32 *bg = (Uint32 *)BG_TILE_RAM(0);
+	Uint16 color;
+	for(y = 0; y < PPU_PIXELS_HEIGHT; y++)
+		for(x = 0; x < PPU_PIXELS_WIDTH; x++) {
+			Uint32 word = ((y >> 3) * PPU_TILES_WIDTH + (x >> 3)) * 8 + (y & 7), shift = (x & 7) << 2;
+#ifdef PPU_PACKED
+			pixel = bg[word] >> shift & 0xf;
+#else
+			pixel = ((Uint32 *)BG_TILE_RAM(2))[word] >> shift & 0xf;
+			if(!pixel)
+				pixel = bg[word] >> shift & 0xf;
+#endif
+			color = BG_PALETTE[pixel];
+			h = (h ^ (color & 0xff)) * 16777619u;
+			h = (h ^ (color >> 8)) * 16777619u;
+		}
+	return h;
+}
+
+static Uint32
+hash_state(void)
+{
+	/* The same over memory, both stacks and the device ports, for checking
+	   the translator against the interpreter. */
+	Uint32 h = 2166136261u, i, j;
+	if(!uxn)
+		return 0;
+	for(i = 0; i < 65536; i++)
+		h = (h ^ uxn->ram.dat[i]) * 16777619u;
+	h = (h ^ uxn->wst.ptr) * 16777619u;
+	for(i = 0; i < uxn->wst.ptr; i++)
+		h = (h ^ uxn->wst.dat[i]) * 16777619u;
+	h = (h ^ uxn->rst.ptr) * 16777619u;
+	for(i = 0; i < uxn->rst.ptr; i++)
+		h = (h ^ uxn->rst.dat[i]) * 16777619u;
+	for(i = 0; i < 16; i++)
+		for(j = 0; j < 16; j++)
+			h = (h ^ uxn->dev[i].dat[j]) * 16777619u;
+	return h;
+}
+
+static void
+report(void)
+{
+	u64 total = 0;
+	Uint32 i;
+	for(i = 0; i < frames; i++)
+		total += frame_ns[i];
+	qsort(frame_ns, frames, sizeof(u64), cmp_u64);
+	printf("frames:        %u\n", frames);
+	printf("instructions:  %llu (%.2f M/s)\n", uxn_instructions,
+		total ? uxn_instructions * 1000.0 / total : 0.0);
+	printf("dispatches:    %llu (%.1f%% fewer)\n", uxn_instructions - uxn_fused,
+		uxn_instructions ? uxn_fused * 100.0 / uxn_instructions : 0.0);
+	printf("suspended:     %u\n", uxn_suspends);
+	printf("frames missed: %u (%u screen vectors dropped)\n", frames_missed, frames_skipped);
+	printf("frames idle:   %u\n", frames_idle);
+	printf("frame time us: p50 %.1f, p90 %.1f, p99 %.1f, max %.1f\n",
+		percentile(frame_ns, frames, 50), percentile(frame_ns, frames, 90),
+		percentile(frame_ns, frames, 99), frame_ns[frames - 1] / 1000.0);
+	printf("tiles copied:  %u (%.2f per frame, %.0f bytes per frame)\n", ppu_tiles_copied,
+		(double)ppu_tiles_copied / frames, (double)ppu_bytes_copied / frames);
+	printf("sprites drawn: %u (%.1f ns per sprite, all work included)\n", ppu_sprites_drawn,
+		ppu_sprites_drawn ? (double)total / ppu_sprites_drawn : 0.0);
+	printf("display hash:  %08x\n", hash_displayed());
+	printf("picture hash:  %08x\n", hash_picture());
+	printf("state hash:    %08x\n", hash_state());
+}
+
+void
+host_vblank(void)
+{
+	u64 now = host_nanoseconds();
+	if(!frame) {
+		printf("boot:          %.1f us\n", (now - time_start) / 1000.0);
+		uxn_instructions = uxn_fused = 0;
+		uxn_suspends = 0;
+		ppu_sprites_drawn = 0;
+		frames_missed = frames_skipped = frames_idle = 0;
+	} else
+		frame_ns[frame - 1] = now - time_last;
+	if(frame++ == frames) {
+		report();
+		exit(0);
+	}
+	time_last = host_nanoseconds();
+}
+
+int
+main(int argc, char **argv)
+{
+	char *uxnds_argv[] = {"uxnds", NULL};
+	static const struct option options[] = {
+		{"jit", no_argument, NULL, 'j'},
+		{"budget", required_argument, NULL, 'b'},
+		{"pacing", no_argument, NULL, 'p'},
+		{NULL, 0, NULL, 0}};
+	int c;
+	/* Frames here take as long as the emulator does, rather than following
+	   the clock; leave them all to the screen vector unless asked. */
+	frame_pacing = false;
+	while((c = getopt_long(argc, argv, "f:i:", options, NULL)) != -1) {
+		switch(c) {
+		case 'f': frames = strtoul(optarg, NULL, 0); break;
+		case 'i': if(!load_script(optarg)) return 1; break;
+		case 'j': if(!jit_init()) return 1; use_jit = 1; break;
+		case 'b': budget = strtoul(optarg, NULL, 0); break;
+		case 'p': frame_pacing = true; break;
+		default: return usage(argv[0]);
+		}
+	}
+	if(optind != argc - 1 || !frames)
+		return usage(argv[0]);
+	/* The translator runs every vector to the end. */
+	if(use_jit && budget) {
+		fprintf(stderr, "%s: --budget does not work with --jit\n", argv[0]);
+		return 1;
+	}
+	vector_budget = budget;
+	if(!realpath(argv[optind], rompath)) {
+		perror(argv[optind]);
+		return 1;
+	}
+	frame_ns = calloc(frames, sizeof(u64));
+	time_start = host_nanoseconds();
+	return uxnds_main(1, uxnds_argv);
+}
@@ -0,0 +1,149 @@
+#include <signal.h>
+#include <time.h>
+#include <sys/time.h>
+#include "host.h"
+
+/* VRAM bank A as main BG memory. copytile() in ppu.c relies on the draw-side
+   tile bases (4, 6) differing from the displayed ones (0, 2) only in bit 16
+   of the address, so the bank must be 128 KiB aligned as it is on hardware. */
+u16 nds_vram_main_bg[0x10000] __attribute__((aligned(0x20000)));
+u16 nds_palette_main_bg[256];
+vu16 nds_registers[16];
+
+static vu16 timer_data[4], timer_cr[4];
+static VoidFn timer_callback;
+static u32 keys_held, keys_prev;
+static HostInput input;
+static Keyboard keyboard;
+static PrintConsole console;
+
+u64
+host_nanoseconds(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (u64)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+#pragma mark - Video
+
+void powerOn(int bits) {}
+void videoSetMode(u32 mode) {}
+void videoSetModeSub(u32 mode) {}
+void vramSetBankA(int mode) {}
+void vramSetBankC(int mode) {}
+void lcdSwap(void) {}
+
+void
+dmaFillWords(u32 value, void *dest, u32 size)
+{
+	u32 *dst = dest;
+	for(size >>= 2; size; size--)
+		*(dst++) = value;
+}
+
+void
+dmaCopyWords(u8 channel, const void *src, void *dest, u32 size)
+{
+	memcpy(dest, src, size);
+}
+
+void
+swiWaitForVBlank(void)
+{
+	host_vblank();
+}
+
+void irqEnable(u32 irq) {}
+void irqDisable(u32 irq) {}
+
+/* Every wait ends at the next frame, as input only changes between frames. */
+void
+swiIntrWait(u32 waitForSet, u32 flags)
+{
+	host_vblank();
+}
+
+#pragma mark - Timers
+
+vu16 *
+nds_timer_data(int timer)
+{
+	/* Timers 0 and 1 are cascaded by the profiler; present them as one
+	   32-bit counter running at the bus clock. */
+	u64 ticks = host_nanoseconds() * (HOST_TIMER_FREQUENCY / 1000) / 1000000;
+	timer_data[0] = ticks;
+	timer_data[1] = ticks >> 16;
+	return &timer_data[timer & 3];
+}
+
+vu16 *
+nds_timer_cr(int timer)
+{
+	return &timer_cr[timer & 3];
+}
+
+static void
+timer_signal(int sig)
+{
+	if(timer_callback)
+		timer_callback();
+}
+
+/* Timer interrupts are delivered as SIGPROF, which ticks with the CPU time
+   of the process; only one timer can have a callback. */
+void
+timerStart(int timer, ClockDivider divider, u16 ticks, VoidFn callback)
+{
+	static const int shift[] = {0, 6, 8, 10};
+	u64 us = (u64)(65536 - ticks) * 1000000 / (HOST_TIMER_FREQUENCY >> shift[divider & 3]);
+	struct itimerval tv = {{us / 1000000, us % 1000000}, {us / 1000000, us % 1000000}};
+	timer_callback = callback;
+	signal(SIGPROF, timer_signal);
+	setitimer(ITIMER_PROF, &tv, NULL);
+}
+
+#pragma mark - Input
+
+void
+scanKeys(void)
+{
+	keys_prev = keys_held;
+	host_input(&input);
+	keys_held = input.held | (input.touching ? KEY_TOUCH : 0);
+}
+
+u32 keysDown(void) { return keys_held & ~keys_prev; }
+u32 keysHeld(void) { return keys_held; }
+
+void
+touchRead(touchPosition *data)
+{
+	memset(data, 0, sizeof(*data));
+	data->px = input.touchx;
+	data->py = input.touchy;
+}
+
+Keyboard *keyboardDemoInit(void) { return &keyboard; }
+Keyboard *keyboardGetDefault(void) { return &keyboard; }
+void keyboardShow(void) {}
+void keyboardHide(void) {}
+
+int
+keyboardUpdate(void)
+{
+	int key = input.key;
+	input.key = -1;
+	return key;
+}
+
+#pragma mark - Console
+
+PrintConsole *consoleDemoInit(void) { return &console; }
+PrintConsole *consoleSelect(PrintConsole *c) { return &console; }
+void consoleSetWindow(PrintConsole *c, int x, int y, int width, int height) {}
+
+#pragma mark - FIFO, FAT
+
+bool fifoSendValue32(int channel, u32 value) { return true; }
+bool fatInitDefault(void) { return true; }
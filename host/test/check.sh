@@ -0,0 +1,105 @@
+#!/bin/sh
+#
+# Build the host variants in turn and check each of them against the
+# reference interpreter of test/fuzz.c and the ROMs of test/roms.
+#
+#   host/test/check.sh [-n programs]
+#
+# or make -C host check. Every ROM listed in test/expected must draw the same
+# picture and leave the same machine state in every variant, with --jit and
+# translated ahead of time as well. The display hash is not compared, as
+# PACKED=true lays the tiles out differently.
+
+PROGRAMS=10000
+if [ "$1" = "-n" ]; then
+	PROGRAMS=$2
+	shift 2
+fi
+
+HOSTDIR=$(cd "$(dirname "$0")/.." && pwd)
+ROMS=$HOSTDIR/test/roms
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+# run from a copy, the profile build writes samples.bin where it runs
+cp -r "$ROMS" "$TMP/roms"
+
+# the ROMs are run in subshells: failures are counted in a file
+fail() {
+	echo "FAIL: $*"
+	echo "$*" >>"$TMP/failed"
+}
+
+field() {
+	sed -n "s/^$1: *//p" "$2"
+}
+
+# build <make vars>: builds the runner and fuzzer of a variant from scratch
+build() {
+	make -s -C "$HOSTDIR" clean >/dev/null
+	if ! make -s -C "$HOSTDIR" $1 all $2 >"$TMP/build.log" 2>&1; then
+		cat "$TMP/build.log"
+		fail "build of ${1:-default}"
+		return 1
+	fi
+}
+
+# fuzz <build dir> <options> <name>
+fuzz() {
+	if "$HOSTDIR/$1/fuzz" -n "$PROGRAMS" $2 >/dev/null 2>"$TMP/fuzz.log"; then
+		echo "  fuzz$3: $(tail -n 1 "$TMP/fuzz.log")"
+	else
+		cat "$TMP/fuzz.log"
+		fail "fuzz$3"
+	fi
+}
+
+# roms <runner> <runner options> <name> [rom]: runs the ROMs of test/expected,
+# or only the given one
+roms() {
+	grep -v '^#' "$HOSTDIR/test/expected" | while read -r rom frames picture state options; do
+		[ -n "$rom" ] || continue
+		[ -z "$4" ] || [ "$rom" = "$4" ] || continue
+		# the budget is kept by the interpreter only
+		case "$2 $options" in *--jit*--budget*) continue ;; esac
+		if ! (cd "$TMP/roms" && "$1" -f "$frames" $2 $options "$rom") >"$TMP/out" 2>&1; then
+			fail "$rom$3 did not run"
+			continue
+		fi
+		p=$(field "picture hash" "$TMP/out")
+		s=$(field "state hash" "$TMP/out")
+		if [ "$p $s" != "$picture $state" ]; then
+			fail "$rom$3: picture $p, state $s; expected $picture, $state"
+		fi
+	done
+}
+
+for vars in "" "THREADED=true" "BIND=false" "PACKED=true" "DEBUG=true" "PROFILE=true"; do
+	echo "${vars:-default}"
+	case "$vars" in
+	DEBUG=*) dir=build_debug runner=uxnds_host_debug ;;
+	PROFILE=*) dir=build_profile runner=uxnds_host_profile ;;
+	*) dir=build runner=uxnds_host ;;
+	esac
+	build "$vars" fuzz || continue
+	fuzz $dir "" ""
+	roms "$HOSTDIR/$runner" "" ""
+	if [ -z "$vars" ] && [ "$(uname -m)" = x86_64 ]; then
+		fuzz $dir "-j" " --jit"
+		roms "$HOSTDIR/$runner" "--jit" " --jit"
+	fi
+done
+
+# ahead of time: every ROM is translated in turn
+grep -v '^#' "$HOSTDIR/test/expected" | while read -r rom rest; do
+	[ -n "$rom" ] || continue
+	echo "AOT=$rom"
+	build "AOT=$ROMS/$rom" || continue
+	roms "$HOSTDIR/uxnds_host_aot" "" " (AOT)" "$rom"
+done
+
+make -s -C "$HOSTDIR" clean >/dev/null
+if [ -s "$TMP/failed" ]; then
+	echo "$(wc -l <"$TMP/failed") failed"
+	exit 1
+fi
+echo "all passed"
@@ -0,0 +1,514 @@
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "../../include/uxn.h"
+#include "../source/host.h"
+#include "uxnfuse.h"
+
+/*
+Differential fuzzer for the uxn core: runs random programs through the
+interpreter as built - or, with -j, the translator in source/jit.c - and
+through a plain reference written from the opcode definitions, one
+instruction at a time, and compares the memory, stacks, device ports and
+the device calls made by both.
+
+  fuzz [-j] [-n programs] [-s seed]
+
+Memory holds random bytes with the superinstructions of uxnfuse.h strewn
+over it, so that fused and plain code both run; the stacks start full of
+random data, half of the time close to their ends. With stack checks, the
+errors must match as well; without, programs that hit one are skipped, as
+the unchecked core leaves them undefined. Half of the programs run with a
+random jump budget, resumed until they finish.
+*/
+
+#define STEPS 100000
+#define CALLS 4096
+
+typedef struct {
+	Uint8 dev, port, w, value;
+	Uint16 value16;
+} Call;
+
+typedef struct {
+	Call calls[CALLS];
+	int count;
+} CallLog;
+
+static Uint8 *ram_ref;
+static Uxn ref, core;
+static CallLog log_ref, log_core, *calls;
+static u32 seed, seed_running;
+
+static u32
+rnd(void)
+{
+	seed = seed * 1103515245 + 12345;
+	return seed >> 8;
+}
+
+#pragma mark - Devices
+
+/* Every device is backed by these: reads come back with a value that depends
+   on the number of calls so far, and writing port 0xe of device 0xf halts the
+   vector. The System halt flag is cleared, resumeuxn would stop on it. */
+static void
+record(Device *d, Uint8 b0, Uint8 w, Uint16 value16)
+{
+	if(calls->count < CALLS) {
+		Call *c = &calls->calls[calls->count];
+		c->dev = d->addr;
+		c->port = b0;
+		c->w = w;
+		c->value = d->dat[b0];
+		c->value16 = value16;
+	}
+	calls->count++;
+}
+
+static int
+fuzz_talk(Device *d, Uint8 b0, Uint8 w)
+{
+	record(d, b0, w, 0);
+	if(!w)
+		d->dat[b0] = d->addr * 31 + b0 * 7 + calls->count;
+	if(d->addr == 0x00)
+		d->dat[0xf] = 0;
+	return !(w && d->addr == 0xf0 && b0 == 0xe);
+}
+
+static int
+fuzz_talk16(Device *d, Uint8 b0, Uint8 w)
+{
+	record(d, b0, w | 2, d->dat[b0] << 8 | d->dat[(b0 + 1) & 0xf]);
+	if(!w) {
+		d->dat[b0] = d->addr * 17 + calls->count;
+		d->dat[(b0 + 1) & 0xf] = b0 * 5 + calls->count;
+	}
+	if(d->addr == 0x00)
+		d->dat[0xf] = 0;
+	return !(w && d->addr == 0xf0 && ((b0 + 1) & 0xf) == 0xe);
+}
+
+/* Builds with BIND_DEVICES call these by name for devices 0x2 to 0x6. */
+int screen_talk(Device *d, Uint8 b0, Uint8 w) { return d->talk(d, b0, w); }
+int screen_talk16(Device *d, Uint8 b0, Uint8 w) { return d->talk16(d, b0, w); }
+int audio_talk(Device *d, Uint8 b0, Uint8 w) { return d->talk(d, b0, w); }
+
+#pragma mark - Reference
+
+/* The reference keeps to the letter of etc/opcodes.txt and of the device
+   access rules in uxn.h, without any of the caching of the core: stacks are
+   tested before every instruction, and a short device access goes to talk16
+   once when either of its ports is hooked. */
+static int
+hooked(Uint16 hook, Uint8 a)
+{
+	return hook >> (a & 0xf) & 1;
+}
+
+static int
+ref_devw8(Device *d, Uint8 a, Uint8 b)
+{
+	d->dat[a & 0xf] = b;
+	return !hooked(d->whook, a) || d->talk(d, a & 0xf, 1);
+}
+
+static Uint8
+ref_devr8(Device *d, Uint8 a)
+{
+	if(hooked(d->rhook, a))
+		d->talk(d, a & 0xf, 0);
+	return d->dat[a & 0xf];
+}
+
+static int
+ref_devw16(Device *d, Uint8 a, Uint16 b)
+{
+	if(d->talk16 && (hooked(d->whook, a) || hooked(d->whook, a + 1))) {
+		d->dat[a & 0xf] = b >> 8;
+		d->dat[(a + 1) & 0xf] = b;
+		return d->talk16(d, a & 0xf, 1);
+	}
+	return ref_devw8(d, a, b >> 8) && ref_devw8(d, a + 1, b);
+}
+
+static Uint16
+ref_devr16(Device *d, Uint8 a)
+{
+	Uint8 hi;
+	if(d->talk16 && (hooked(d->rhook, a) || hooked(d->rhook, a + 1))) {
+		d->talk16(d, a & 0xf, 0);
+		return d->dat[a & 0xf] << 8 | d->dat[(a + 1) & 0xf];
+	}
+	hi = ref_devr8(d, a);
+	return hi << 8 | ref_devr8(d, a + 1);
+}
+
+/* Bytes each opcode pops from its stack and pushes back onto it, in byte and
+   short mode, and pushes onto the other stack. */
+static const struct {
+	Uint8 pop[2], push[2], other[2];
+} effects_ref[32] = {
+	{{0, 0}, {1, 2}, {0, 0}}, /* LIT */
+	{{1, 2}, {1, 2}, {0, 0}}, /* INC */
+	{{1, 2}, {0, 0}, {0, 0}}, /* POP */
+	{{1, 2}, {2, 4}, {0, 0}}, /* DUP */
+	{{2, 4}, {1, 2}, {0, 0}}, /* NIP */
+	{{2, 4}, {2, 4}, {0, 0}}, /* SWP */
+	{{2, 4}, {3, 6}, {0, 0}}, /* OVR */
+	{{3, 6}, {3, 6}, {0, 0}}, /* ROT */
+	{{2, 4}, {1, 1}, {0, 0}}, /* EQU */
+	{{2, 4}, {1, 1}, {0, 0}}, /* NEQ */
+	{{2, 4}, {1, 1}, {0, 0}}, /* GTH */
+	{{2, 4}, {1, 1}, {0, 0}}, /* LTH */
+	{{1, 2}, {0, 0}, {0, 0}}, /* JMP */
+	{{2, 3}, {0, 0}, {0, 0}}, /* JCN */
+	{{1, 2}, {0, 0}, {2, 2}}, /* JSR */
+	{{1, 2}, {0, 0}, {1, 2}}, /* STH */
+	{{1, 1}, {1, 2}, {0, 0}}, /* LDZ */
+	{{2, 3}, {0, 0}, {0, 0}}, /* STZ */
+	{{1, 1}, {1, 2}, {0, 0}}, /* LDR */
+	{{2, 3}, {0, 0}, {0, 0}}, /* STR */
+	{{2, 2}, {1, 2}, {0, 0}}, /* LDA */
+	{{3, 4}, {0, 0}, {0, 0}}, /* STA */
+	{{1, 1}, {1, 2}, {0, 0}}, /* DEI */
+	{{2, 3}, {0, 0}, {0, 0}}, /* DEO */
+	{{2, 4}, {1, 2}, {0, 0}}, /* ADD */
+	{{2, 4}, {1, 2}, {0, 0}}, /* SUB */
+	{{2, 4}, {1, 2}, {0, 0}}, /* MUL */
+	{{2, 4}, {1, 2}, {0, 0}}, /* DIV */
+	{{2, 4}, {1, 2}, {0, 0}}, /* AND */
+	{{2, 4}, {1, 2}, {0, 0}}, /* ORA */
+	{{2, 4}, {1, 2}, {0, 0}}, /* EOR */
+	{{2, 3}, {1, 2}, {0, 0}}, /* SFT */
+};
+
+typedef struct {
+	Stack *s;
+	Uint8 ptr;
+	int keep;
+} Pops;
+
+static Uint8
+pop8(Pops *p)
+{
+	if(p->keep)
+		return p->s->dat[--p->ptr];
+	return p->s->dat[--p->s->ptr];
+}
+
+static Uint16
+popv(Pops *p, int sh)
+{
+	Uint8 lo = pop8(p);
+	return sh ? pop8(p) << 8 | lo : lo;
+}
+
+static void
+push8(Stack *s, Uint8 v)
+{
+	s->dat[s->ptr++] = v;
+}
+
+static void
+pushv(Stack *s, Uint16 v, int sh)
+{
+	if(sh)
+		push8(s, v >> 8);
+	push8(s, v);
+}
+
+static void
+storev(Uint8 *m, Uint16 a, Uint16 v, int sh)
+{
+	if(sh) {
+		m[a] = v >> 8;
+		m[(Uint16)(a + 1)] = v;
+	} else
+		m[a] = v;
+}
+
+static Uint16
+loadv(Uint8 *m, Uint16 a, int sh)
+{
+	return sh ? m[a] << 8 | m[(Uint16)(a + 1)] : m[a];
+}
+
+/* Runs vec as evaluxn would with stack checks when checked is set: 1 at BRK
+   or a halting device write, 0 on an error and -1 if it takes too long. The
+   instruction that halts leaves its operands on the stack. */
+static int
+ref_evaluxn(Uxn *u, Uint16 vec, int checked)
+{
+	Uint8 *ram = u->ram.dat;
+	Uint16 pc = vec;
+	long steps;
+	if(!vec || u->dev[0].dat[0xf])
+		return 0;
+	if(u->wst.ptr > 0xf8)
+		u->wst.ptr = 0xf8;
+	for(steps = 0; steps < STEPS; steps++) {
+		Uint8 instr = ram[pc++], op = instr & 0x1f, sh = !!(instr & 0x20);
+		Stack *src = instr & 0x40 ? &u->rst : &u->wst, *dst = instr & 0x40 ? &u->wst : &u->rst;
+		Pops p = {src, src->ptr, instr & 0x80};
+		Uint8 start = src->ptr;
+		Uint16 a, b;
+		if(!instr) {
+			u->ram.ptr = pc;
+			return 1;
+		}
+		if(src->ptr < effects_ref[op].pop[sh]) {
+			src->error = 1;
+			u->ram.ptr = pc;
+			return 0;
+		}
+		if((p.keep ? src->ptr : src->ptr - effects_ref[op].pop[sh]) + effects_ref[op].push[sh] > 255) {
+			src->error = 2;
+			u->ram.ptr = pc;
+			return 0;
+		}
+		if(dst->ptr + effects_ref[op].other[sh] > 255) {
+			dst->error = 2;
+			u->ram.ptr = pc;
+			return 0;
+		}
+		switch(op) {
+		case 0x00: /* LIT */
+			pushv(src, loadv(ram, pc, sh), sh);
+			pc += 1 + sh;
+			break;
+		case 0x01: a = popv(&p, sh); pushv(src, a + 1, sh); break;
+		case 0x02: popv(&p, sh); break;
+		case 0x03: a = popv(&p, sh); pushv(src, a, sh); pushv(src, a, sh); break;
+		case 0x04: a = popv(&p, sh); popv(&p, sh); pushv(src, a, sh); break;
+		case 0x05: a = popv(&p, sh); b = popv(&p, sh); pushv(src, a, sh); pushv(src, b, sh); break;
+		case 0x06: a = popv(&p, sh); b = popv(&p, sh); pushv(src, b, sh); pushv(src, a, sh); pushv(src, b, sh); break;
+		case 0x07: {
+			Uint16 c;
+			a = popv(&p, sh);
+			b = popv(&p, sh);
+			c = popv(&p, sh);
+			pushv(src, b, sh);
+			pushv(src, a, sh);
+			pushv(src, c, sh);
+			break;
+		}
+		case 0x08: a = popv(&p, sh); b = popv(&p, sh); push8(src, b == a); break;
+		case 0x09: a = popv(&p, sh); b = popv(&p, sh); push8(src, b != a); break;
+		case 0x0a: a = popv(&p, sh); b = popv(&p, sh); push8(src, b > a); break;
+		case 0x0b: a = popv(&p, sh); b = popv(&p, sh); push8(src, b < a); break;
+		case 0x0c: /* JMP */
+			a = popv(&p, sh);
+			pc = sh ? a : pc + (Sint8)a;
+			break;
+		case 0x0d: /* JCN */
+			a = popv(&p, sh);
+			if(pop8(&p))
+				pc = sh ? a : pc + (Sint8)a;
+			break;
+		case 0x0e: /* JSR */
+			a = popv(&p, sh);
+			pushv(dst, pc, 1);
+			pc = sh ? a : pc + (Sint8)a;
+			break;
+		case 0x0f: a = popv(&p, sh); pushv(dst, a, sh); break;
+		case 0x10: a = pop8(&p); pushv(src, loadv(ram, a, sh), sh); break;
+		case 0x11: a = pop8(&p); b = popv(&p, sh); storev(ram, a, b, sh); break;
+		case 0x12: a = pop8(&p); pushv(src, loadv(ram, pc + (Sint8)a, sh), sh); break;
+		case 0x13: a = pop8(&p); b = popv(&p, sh); storev(ram, pc + (Sint8)a, b, sh); break;
+		case 0x14: a = popv(&p, 1); pushv(src, loadv(ram, a, sh), sh); break;
+		case 0x15: a = popv(&p, 1); b = popv(&p, sh); storev(ram, a, b, sh); break;
+		case 0x16: /* DEI */
+			a = pop8(&p);
+			u->ram.ptr = pc;
+			pushv(src, sh ? ref_devr16(&u->dev[a >> 4], a) : ref_devr8(&u->dev[a >> 4], a), sh);
+			break;
+		case 0x17: /* DEO */
+			a = pop8(&p);
+			b = popv(&p, sh);
+			u->ram.ptr = pc;
+			if(!(sh ? ref_devw16(&u->dev[a >> 4], a, b) : ref_devw8(&u->dev[a >> 4], a, b))) {
+				src->ptr = start;
+				return 1;
+			}
+			break;
+		case 0x18: a = popv(&p, sh); b = popv(&p, sh); pushv(src, b + a, sh); break;
+		case 0x19: a = popv(&p, sh); b = popv(&p, sh); pushv(src, b - a, sh); break;
+		case 0x1a: a = popv(&p, sh); b = popv(&p, sh); pushv(src, b * a, sh); break;
+		case 0x1b: /* DIV */
+			a = popv(&p, sh);
+			b = popv(&p, sh);
+			if(!a) {
+				src->error = 3;
+				if(checked) {
+					src->ptr = start;
+					u->ram.ptr = pc;
+					return 0;
+				}
+				a = 1;
+			}
+			pushv(src, b / a, sh);
+			break;
+		case 0x1c: a = popv(&p, sh); b = popv(&p, sh); pushv(src, b & a, sh); break;
+		case 0x1d: a = popv(&p, sh); b = popv(&p, sh); pushv(src, b | a, sh); break;
+		case 0x1e: a = popv(&p, sh); b = popv(&p, sh); pushv(src, b ^ a, sh); break;
+		case 0x1f: /* SFT */
+			a = pop8(&p);
+			b = popv(&p, sh);
+			if(sh)
+				pushv(src, b >> (a & 0x0f) << ((a & 0xf0) >> 4), 1);
+			else
+				push8(src, b >> (a & 0x07) << ((a & 0x70) >> 4));
+			break;
+		}
+	}
+	return -1;
+}
+
+#pragma mark - Programs
+
+/* Fills u with the program and starting state of seed s, returning the
+   vector to run; both machines get the same. */
+static Uint16
+setup(Uxn *u, u32 s)
+{
+	Uint8 *ram = u->ram.dat;
+	Uint16 vec;
+	int i, j, lowstacks;
+	seed = s;
+	for(i = 0; i < 0x10000; i++)
+		ram[i] = rnd();
+	for(i = PAGE_PROGRAM; i < 0x10000 - FUSE_SPAN; i += 1 + (rnd() & 7)) {
+		int f = rnd() % FUSE_COUNT;
+		for(j = 0; j < fusions[f].length; j++)
+			if(fusions[f].opcodes >> j & 1)
+				ram[i + j] = fusions[f].code[j];
+	}
+	vec = PAGE_PROGRAM + (rnd() & 0xff);
+	lowstacks = rnd() & 1;
+	u->wst.ptr = rnd();
+	u->rst.ptr = rnd();
+	if(lowstacks) {
+		u->wst.ptr &= 0x1f;
+		u->rst.ptr &= 0x1f;
+	}
+	u->wst.error = u->rst.error = 0;
+	for(i = 0; i < 256; i++) {
+		u->wst.dat[i] = rnd();
+		u->rst.dat[i] = rnd();
+	}
+	for(i = 0; i < 16; i++) {
+		Device *d = &u->dev[i];
+		d->rhook = rnd();
+		d->whook = rnd();
+		d->talk16 = rnd() & 1 ? fuzz_talk16 : NULL;
+		for(j = 0; j < 16; j++)
+			d->dat[j] = rnd();
+	}
+	u->dev[0x0].whook |= 1 << 0xf;
+	u->dev[0x0].dat[0xf] = 0;
+	u->budget = rnd() & 1 ? 1 + rnd() % 64 : 0;
+	u->suspended = 0;
+	return vec;
+}
+
+static const char *
+compare(void)
+{
+	int i;
+	if(ref.ram.ptr != core.ram.ptr)
+		return "pc";
+	if(ref.wst.error != core.wst.error || ref.rst.error != core.rst.error)
+		return "error";
+	if(ref.wst.ptr != core.wst.ptr || memcmp(ref.wst.dat, core.wst.dat, ref.wst.ptr))
+		return "working stack";
+	if(ref.rst.ptr != core.rst.ptr || memcmp(ref.rst.dat, core.rst.dat, ref.rst.ptr))
+		return "return stack";
+	if(memcmp(ref.ram.dat, core.ram.dat, 0x10000))
+		return "memory";
+	for(i = 0; i < 16; i++)
+		if(memcmp(ref.dev[i].dat, core.dev[i].dat, 16))
+			return "device ports";
+	if(log_ref.count != log_core.count ||
+		memcmp(log_ref.calls, log_core.calls, sizeof(Call) * (log_ref.count < CALLS ? log_ref.count : CALLS)))
+		return "device calls";
+	return NULL;
+}
+
+/* A core that loops where the reference did not is a mismatch too. */
+static void
+timeout(int sig)
+{
+	fprintf(stderr, "seed %u: still running\n", seed_running);
+	exit(1);
+}
+
+int
+main(int argc, char **argv)
+{
+	int use_jit = 0, checked = 0, c, i;
+	long programs = 10000, n, skipped = 0, mismatches = 0;
+	u32 seed0 = 1;
+	while((c = getopt(argc, argv, "jn:s:")) != -1) {
+		switch(c) {
+		case 'j': use_jit = 1; break;
+		case 'n': programs = atol(optarg); break;
+		case 's': seed0 = strtoul(optarg, NULL, 0); break;
+		default:
+			fprintf(stderr, "usage: %s [-j] [-n programs] [-s seed]\n", argv[0]);
+			return 1;
+		}
+	}
+#ifdef CPU_ERROR_CHECKING
+	checked = 1;
+#endif
+	signal(SIGALRM, timeout);
+	if(use_jit && !jit_init())
+		return 1;
+	if(!bootuxn(&core))
+		return 1;
+	ram_ref = calloc(0x10000, 1);
+	ref.ram.dat = ram_ref;
+	for(i = 0; i < 16; i++) {
+		portuxn(&ref, i, "fuzz", fuzz_talk, 0, 0);
+		portuxn(&core, i, "fuzz", fuzz_talk, 0, 0);
+	}
+	for(n = 0; n < programs; n++) {
+		u32 s = seed0 + n * 7919;
+		Uint16 vec;
+		int rv_ref, rv_core, resumes;
+		const char *diff;
+		vec = setup(&ref, s);
+		calls = &log_ref;
+		log_ref.count = 0;
+		rv_ref = ref_evaluxn(&ref, vec, checked);
+		if(rv_ref < 0 || (!checked && rv_ref == 0)) {
+			skipped++;
+			continue;
+		}
+		vec = setup(&core, s);
+		if(use_jit)
+			core.budget = 0;
+		memset(core.ram.fuse, 0, 0x10000);
+		fuseuxn(&core, PAGE_PROGRAM, 0x10000 - PAGE_PROGRAM);
+		if(use_jit)
+			jit_flush();
+		calls = &log_core;
+		log_core.count = 0;
+		seed_running = s;
+		alarm(10);
+		rv_core = use_jit ? jit_evaluxn(&core, vec) : evaluxn(&core, vec);
+		for(resumes = 0; rv_core == UXN_SUSPENDED && resumes < STEPS; resumes++)
+			rv_core = resumeuxn(&core);
+		alarm(0);
+		diff = rv_ref != rv_core ? "return value" : compare();
+		if(diff && ++mismatches <= 10)
+			fprintf(stderr, "seed %u: %s differs (returned %d/%d, pc %04x/%04x, stacks %02x %02x/%02x %02x, budget %u)\n",
+				s, diff, rv_ref, rv_core, ref.ram.ptr, core.ram.ptr,
+				ref.wst.ptr, ref.rst.ptr, core.wst.ptr, core.rst.ptr, core.budget);
+	}
+	fprintf(stderr, "%ld programs, %ld skipped, %ld mismatches\n", programs, skipped, mismatches);
+	return mismatches != 0;
+}
@@ -20,7 +20,11 @@ WITH REGARD TO THIS SOFTWARE.
 #define dprintf(...)
 #endif
 
+#ifdef UXNDS_HOST
+#define ITCM_ARM_CODE
+#else
 #define ITCM_ARM_CODE __attribute__((section(".itcm"), long_call, target("arm")))
+#endif
 
 typedef uint8_t Uint8;
 typedef int8_t Sint8;
@@ -29,29 +33,50 @@ typedef int16_t Sint16;
 
 #define PAGE_PROGRAM 0x0100
 
+/* Banks of 64 KiB in ram.dat: bank 0 is the memory uxn runs in, the others
+   hold the rest of a larger ROM and are reached through the System
+   expansion commands. Four of them take a quarter of the DS's 4 MiB. */
+#ifndef UXN_BANKS
+#define UXN_BANKS 4
+#endif
+
 typedef struct {
 	Uint8 ptr, kptr, error;
 	Uint8 dat[256];
 } Stack;
 
+typedef struct {
+	Uint16 addr;
+	Uint8 wlo, wspan, rlo, rspan;
+} Block;
+
 typedef struct {
 	Uint16 ptr;
-	Uint8 *dat;
+	Uint8 *dat, *fuse, *code;
+	Block *blocks;
 } Memory;
 
 typedef struct Device {
 	struct Uxn *u;
 	Uint8 addr, dat[16], *mem;
 	Uint16 vector;
+	Uint16 rhook, whook; /* ports whose reads and writes go through talk */
 	int (*talk)(struct Device *d, Uint8, Uint8);
+	int (*talk16)(struct Device *d, Uint8, Uint8); /* both bytes of a short at once, if set */
 } Device;
 
 typedef struct Uxn {
 	Stack wst, rst;
 	Memory ram;
 	Device dev[16];
+	u32 budget;       /* jumps a vector may take before it is suspended, 0 for no limit */
+	Uint16 suspended; /* the vector that was suspended, 0 if none; it goes on from ram.ptr */
 } Uxn;
 
+/* evaluxn and resumeuxn return this when the vector ran out of budget;
+   evaluxn does not start another vector until it has been resumed. */
+#define UXN_SUSPENDED 2
+
 struct Uxn;
 
 static inline void   poke8(Uint8 *m, Uint16 a, Uint8 b) { m[a] = b; }
@@ -62,4 +87,31 @@ static inline Uint16 peek16(Uint8 *m, Uint16 a) { return (peek8(m, a) << 8) + pe
 int loaduxn(Uxn *c, char *filepath);
 int bootuxn(Uxn *c);
 int evaluxn(Uxn *u, Uint16 vec);
-Device *portuxn(Uxn *u, Uint8 id, char *name, int (*talkfn)(Device *, Uint8, Uint8));
+int resumeuxn(Uxn *u);
+int runuxn(Uxn *u, Uint16 pc);
+void fuseuxn(Uxn *u, Uint16 addr, Uint16 length);
+Device *portuxn(Uxn *u, Uint8 id, char *name, int (*talkfn)(Device *, Uint8, Uint8), Uint16 rhook, Uint16 whook);
+
+#if defined(UXNDS_HOST) || defined(DEBUG_PROFILE)
+#define UXN_COUNTERS
+/* Instructions run, and how many of them ran as part of a superinstruction
+   instead of being dispatched on their own; times a vector was suspended. */
+extern unsigned long long uxn_instructions, uxn_fused;
+extern u32 uxn_suspends;
+#endif
+
+#ifdef DEBUG_PROFILE
+/* Executions of each opcode and of the instruction at each address, which
+   the profile build writes to profile.bin on request. */
+extern u32 uxn_opcode_counts[256], uxn_addr_counts[65536];
+/* The address of the instruction being run with the return stack pointer
+   in bits 16-23, and the vector it belongs to, 0 between vectors. */
+extern volatile u32 uxn_at;
+extern volatile Uint16 uxn_vector;
+#endif
+
+#ifdef UXNDS_HOST
+/* Called by fuseuxn with every range of memory loaded behind the back of the
+   interpreter, for the code caches of the host build. */
+extern void (*uxn_load_hook)(Uxn *u, Uint16 addr, Uint16 length);
+#endif